@@ -1,44 +1,41 @@
 #include "AlteraDevices.hpp"
 #include "../LogicDesign.hpp"
 #include "../Util.hpp"
+#include "../BinaryNetlist.hpp"
 using namespace std;
 namespace SynthFramework {
   namespace Polymer {
-      Altera_CarrySum::Altera_CarrySum() {
-          name = "carrysum_" + to_string(cscount);
-          cscount++;
+      Altera_CarrySum::Altera_CarrySum() : VendorSpecificDevice(DEVICE_ALTERA_CARRYSUM) {
+          name = "carrysum_" + to_string(createdCount[DEVICE_ALTERA_CARRYSUM]);
+          createdCount[DEVICE_ALTERA_CARRYSUM]++;
       }
 
-      Altera_CarrySum::Altera_CarrySum(Signal *sin, Signal *cin, Signal *sout, Signal *cout) {
-          name = "carrysum_" + to_string(cscount);
-          cscount++;
+      Altera_CarrySum::Altera_CarrySum(Signal *sin, Signal *cin, Signal *sout, Signal *cout) : VendorSpecificDevice(DEVICE_ALTERA_CARRYSUM) {
+          name = "carrysum_" + to_string(createdCount[DEVICE_ALTERA_CARRYSUM]);
+          createdCount[DEVICE_ALTERA_CARRYSUM]++;
 
           DeviceInputPort *sip = new DeviceInputPort();
           sip->device = this;
           sip->pin = 0;
-          sip->connectedNet = sin;
-          sin->connectedPorts.push_back(sip);
+          sip->Connect(sin);
           inputPorts.push_back(sip);
 
           DeviceInputPort *cip = new DeviceInputPort();
           cip->device = this;
           cip->pin = 1;
-          cip->connectedNet = cin;
-          cin->connectedPorts.push_back(cip);
+          cip->Connect(cin);
           inputPorts.push_back(cip);
 
           DeviceOutputPort *sop = new DeviceOutputPort();
           sop->device = this;
           sop->pin = 0;
-          sop->connectedNet = sout;
-          sout->connectedPorts.push_back(sop);
+          sop->Connect(sout);
           outputPorts.push_back(sop);
 
           DeviceOutputPort *cop = new DeviceOutputPort();
           cop->device = this;
           cop->pin = 1;
-          cop->connectedNet = cout;
-          cout->connectedPorts.push_back(cop);
+          cop->Connect(cout);
           outputPorts.push_back(cop);
 
     }
@@ -67,31 +64,33 @@ namespace SynthFramework {
         return optimised;
     }
 
-    int Altera_CarrySum::cscount;
+    LogicDevice *Altera_CarrySum::Clone() {
+        Altera_CarrySum *copy = new Altera_CarrySum(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
 
-    Altera_ROM::Altera_ROM() {
-        name = "ROM1_" + to_string(romcount);
-        romcount++;
+    Altera_ROM::Altera_ROM() : VendorSpecificDevice(DEVICE_ALTERA_ROM) {
+        name = "ROM1_" + to_string(createdCount[DEVICE_ALTERA_ROM]);
+        createdCount[DEVICE_ALTERA_ROM]++;
     }
-    Altera_ROM::Altera_ROM(int _width, int _length, string _filename, Signal *clock, vector<Signal*> address, vector<Signal*> data) {
-        name = "ROM1_" + to_string(romcount);
-        romcount++;
+    Altera_ROM::Altera_ROM(int _width, int _length, string _filename, Signal *clock, vector<Signal*> address, vector<Signal*> data) : VendorSpecificDevice(DEVICE_ALTERA_ROM) {
+        name = "ROM1_" + to_string(createdCount[DEVICE_ALTERA_ROM]);
+        createdCount[DEVICE_ALTERA_ROM]++;
         width = _width;
         length = _length;
         filename = _filename;
         DeviceInputPort *cip = new DeviceInputPort();
         cip->device = this;
         cip->pin = 0;
-        cip->connectedNet = clock;
-        clock->connectedPorts.push_back(cip);
+        cip->Connect(clock);
         inputPorts.push_back(cip);
 
         for(int i = 0; i < address.size(); i++) {
             DeviceInputPort *aip = new DeviceInputPort();
             aip->device = this;
             aip->pin = i+1;
-            aip->connectedNet = address[i];
-            address[i]->connectedPorts.push_back(aip);
+            aip->Connect(address[i]);
             inputPorts.push_back(aip);
         }
 
@@ -99,43 +98,55 @@ namespace SynthFramework {
             DeviceOutputPort *dop = new DeviceOutputPort();
             dop->device = this;
             dop->pin = i;
-            dop->connectedNet = data[i];
-            data[i]->connectedPorts.push_back(dop);
+            dop->Connect(data[i]);
             outputPorts.push_back(dop);
         }
     }
 
-    int Altera_ROM::romcount;
+    LogicDevice *Altera_ROM::Clone() {
+        Altera_ROM *copy = new Altera_ROM(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
 
-    Altera_Multiplier18::Altera_Multiplier18() {
-        name = "MUL18_" + to_string(mulcount);
-        mulcount++;
+    void Altera_ROM::WriteConfig(BinaryWriter &out) {
+        out.WriteInt(width);
+        out.WriteInt(length);
+        out.WriteString(filename);
     }
-    Altera_Multiplier18::Altera_Multiplier18(vector<Signal*> a, vector<Signal*> b, vector<Signal*> out, bool _sign_a, bool _sign_b) {
-        name = "MUL18_" + to_string(mulcount);
-        mulcount++;
+
+    void Altera_ROM::ReadConfig(BinaryReader &in) {
+        width = in.ReadInt();
+        length = in.ReadInt();
+        filename = in.ReadString();
+    }
+
+    Altera_Multiplier18::Altera_Multiplier18() : VendorSpecificDevice(DEVICE_ALTERA_MULTIPLIER18) {
+        name = "MUL18_" + to_string(createdCount[DEVICE_ALTERA_MULTIPLIER18]);
+        createdCount[DEVICE_ALTERA_MULTIPLIER18]++;
+    }
+    Altera_Multiplier18::Altera_Multiplier18(vector<Signal*> a, vector<Signal*> b, vector<Signal*> out, bool _sign_a, bool _sign_b) : VendorSpecificDevice(DEVICE_ALTERA_MULTIPLIER18) {
+        name = "MUL18_" + to_string(createdCount[DEVICE_ALTERA_MULTIPLIER18]);
+        createdCount[DEVICE_ALTERA_MULTIPLIER18]++;
         for(int i = 0; i < 18; i++) {
             DeviceInputPort *aip = new DeviceInputPort();
             aip->device = this;
             aip->pin = i;
-            aip->connectedNet = a[i];
-            a[i]->connectedPorts.push_back(aip);
+            aip->Connect(a[i]);
             inputPorts.push_back(aip);
         }
         for(int i = 0; i < 18; i++) {
             DeviceInputPort *bip = new DeviceInputPort();
             bip->device = this;
             bip->pin = i + 18;
-            bip->connectedNet = b[i];
-            b[i]->connectedPorts.push_back(bip);
+            bip->Connect(b[i]);
             inputPorts.push_back(bip);
         }
         for(int i = 0; i < 36; i++) {
             DeviceOutputPort *op = new DeviceOutputPort();
             op->device = this;
             op->pin = i;
-            op->connectedNet = out[i];
-            out[i]->connectedPorts.push_back(op);
+            op->Connect(out[i]);
             outputPorts.push_back(op);
         }
         sign_a = _sign_a;
@@ -181,8 +192,7 @@ namespace SynthFramework {
             for(int i = newActualSize; i < actualsize; i++) {
                 Signal *dummy = topLevel->CreateSignal(name + "_do_" + to_string(i));
                 outputPorts[i]->Disconnect();
-                outputPorts[i]->connectedNet = dummy;
-                dummy->connectedPorts.push_back(outputPorts[i]);
+                outputPorts[i]->Connect(dummy);
             }
             actualsize = newActualSize;
             PrintMessage(MSG_DEBUG, "multiplier " + name + " has an actual output size of " + to_string(newActualSize));
@@ -191,6 +201,87 @@ namespace SynthFramework {
             return false;
         }
     }
-    int Altera_Multiplier18::mulcount;
+    LogicDevice *Altera_Multiplier18::Clone() {
+        Altera_Multiplier18 *copy = new Altera_Multiplier18(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
+
+    void Altera_Multiplier18::WriteConfig(BinaryWriter &out) {
+        out.WriteBool(sign_a);
+        out.WriteBool(sign_b);
+        out.WriteInt(actualsize);
+    }
+
+    void Altera_Multiplier18::ReadConfig(BinaryReader &in) {
+        sign_a = in.ReadBool();
+        sign_b = in.ReadBool();
+        actualsize = in.ReadInt();
+    }
+
+    Altera_ShiftTaps::Altera_ShiftTaps() : VendorSpecificDevice(DEVICE_ALTERA_SHIFTTAPS) {
+        name = "SHIFT_" + to_string(createdCount[DEVICE_ALTERA_SHIFTTAPS]);
+        createdCount[DEVICE_ALTERA_SHIFTTAPS]++;
+    }
+
+    Altera_ShiftTaps::Altera_ShiftTaps(int _depth, vector<Signal*> D, Signal *clock, Signal *enable, vector<Signal*> Q) : VendorSpecificDevice(DEVICE_ALTERA_SHIFTTAPS) {
+        name = "SHIFT_" + to_string(createdCount[DEVICE_ALTERA_SHIFTTAPS]);
+        createdCount[DEVICE_ALTERA_SHIFTTAPS]++;
+        width = D.size();
+        depth = _depth;
+        hasEnable = (enable != nullptr);
+        for(int i = 0; i < width; i++) {
+            DeviceInputPort *dip = new DeviceInputPort();
+            dip->device = this;
+            dip->pin = i;
+            dip->Connect(D[i]);
+            inputPorts.push_back(dip);
+        }
+
+        DeviceInputPort *cip = new DeviceInputPort();
+        cip->device = this;
+        cip->pin = width;
+        cip->Connect(clock);
+        inputPorts.push_back(cip);
+
+        if(hasEnable) {
+            DeviceInputPort *eip = new DeviceInputPort();
+            eip->device = this;
+            eip->pin = width + 1;
+            eip->Connect(enable);
+            inputPorts.push_back(eip);
+        }
+
+        for(int i = 0; i < width; i++) {
+            DeviceOutputPort *qop = new DeviceOutputPort();
+            qop->device = this;
+            qop->pin = i;
+            qop->Connect(Q[i]);
+            outputPorts.push_back(qop);
+        }
+    }
+
+    LogicDevice *Altera_ShiftTaps::Clone() {
+        Altera_ShiftTaps *copy = new Altera_ShiftTaps(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
+
+    void Altera_ShiftTaps::WriteConfig(BinaryWriter &out) {
+        out.WriteInt(width);
+        out.WriteInt(depth);
+        out.WriteBool(hasEnable);
+    }
+
+    void Altera_ShiftTaps::ReadConfig(BinaryReader &in) {
+        width = in.ReadInt();
+        depth = in.ReadInt();
+        hasEnable = in.ReadBool();
+    }
+
+    bool Altera_ShiftTaps::IsRegisteredInput(int input) {
+        return input < width;
+    }
+
   }
 }
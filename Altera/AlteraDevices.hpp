@@ -11,31 +11,50 @@ namespace SynthFramework {
       class Altera_CarrySum : public VendorSpecificDevice {
       public:
           Altera_CarrySum();
+          static bool IsKind(DeviceKind k) { return k == DEVICE_ALTERA_CARRYSUM; };
           Altera_CarrySum(Signal *sin, Signal *cin, Signal *sout, Signal *cout);
           virtual bool OptimiseDevice(LogicDesign *topLevel);
-      private:
-          static int cscount;
+          LogicDevice *Clone();
       };
       //Altera single-port ROM primitive
       class Altera_ROM : public VendorSpecificDevice {
       public:
           Altera_ROM();
+          static bool IsKind(DeviceKind k) { return k == DEVICE_ALTERA_ROM; };
           Altera_ROM(int _width, int _length, string _filename, Signal *clock, vector<Signal*> address, vector<Signal*> data);
+          LogicDevice *Clone();
+          void WriteConfig(BinaryWriter &out);
+          void ReadConfig(BinaryReader &in);
           int width, length;
           string filename;
-      private:
-          static int romcount;
       };
       //Altera 18x18 embedded multiplier (9x9 mode and registers NYI at the moment)
       class Altera_Multiplier18 : public VendorSpecificDevice {
       public:
         Altera_Multiplier18();
+        static bool IsKind(DeviceKind k) { return k == DEVICE_ALTERA_MULTIPLIER18; };
         Altera_Multiplier18(vector<Signal*> a, vector<Signal*> b, vector<Signal*> out, bool _sign_a, bool _sign_b);
         virtual bool OptimiseDevice(LogicDesign *topLevel);
+        LogicDevice *Clone();
+        void WriteConfig(BinaryWriter &out);
+        void ReadConfig(BinaryReader &in);
         bool sign_a, sign_b;
       private:
-        static int mulcount;
         int actualsize = 36; //for optimisation purposes
     };
+      //RAM based shift register, delaying a group of bits by the same number of cycles using altshift_taps
+      class Altera_ShiftTaps : public VendorSpecificDevice {
+      public:
+          Altera_ShiftTaps();
+          static bool IsKind(DeviceKind k) { return k == DEVICE_ALTERA_SHIFTTAPS; };
+          //Delays each bit of D by depth clock cycles. enable may be nullptr if the shift register is always enabled
+          Altera_ShiftTaps(int _depth, vector<Signal*> D, Signal *clock, Signal *enable, vector<Signal*> Q);
+          LogicDevice *Clone();
+          void WriteConfig(BinaryWriter &out);
+          void ReadConfig(BinaryReader &in);
+          bool IsRegisteredInput(int input);
+          int width = 1, depth = 3;
+          bool hasEnable = false;
+      };
   };
 };
@@ -25,37 +25,34 @@ namespace SynthFramework {
         }
 
         string CycloneIIITechnology::GenerateDevice(LogicDevice* dev) {
-            LUT* lut = dynamic_cast<LUT*>(dev);
-            FlipFlop *ff= dynamic_cast<FlipFlop*>(dev);
-            Altera_CarrySum *cs = dynamic_cast<Altera_CarrySum*>(dev);
-            Altera_ROM *rom = dynamic_cast<Altera_ROM*>(dev);
-            Altera_Multiplier18 *mul18 = dynamic_cast<Altera_Multiplier18*>(dev);
-            if(lut != nullptr) {
-                return SynthesiseLUT(lut);
-            } else if(ff != nullptr) {
-                return SynthesiseFF(ff);
-            } else if(cs != nullptr) {
-                return SynthesiseCarrySum(cs);
-            } else if(rom != nullptr) {
-                return SynthesiseROM(rom);
-            } else if(mul18 != nullptr) {
-                return SynthesiseMultiplier(mul18);
-            } else {
+            switch(dev->kind) {
+            case DEVICE_LUT:
+                return SynthesiseLUT(static_cast<LUT*>(dev));
+            case DEVICE_FLIPFLOP:
+                return SynthesiseFF(static_cast<FlipFlop*>(dev));
+            case DEVICE_ALTERA_CARRYSUM:
+                return SynthesiseCarrySum(static_cast<Altera_CarrySum*>(dev));
+            case DEVICE_ALTERA_ROM:
+                return SynthesiseROM(static_cast<Altera_ROM*>(dev));
+            case DEVICE_ALTERA_MULTIPLIER18:
+                return SynthesiseMultiplier(static_cast<Altera_Multiplier18*>(dev));
+            case DEVICE_ALTERA_SHIFTTAPS:
+                return SynthesiseShiftTaps(static_cast<Altera_ShiftTaps*>(dev));
+            default:
                 return "";
             }
         }
         string CycloneIIITechnology::GenerateDeviceSignals(LogicDevice* dev) {
-            LUT* lut = dynamic_cast<LUT*>(dev);
-            Altera_ROM *rom = dynamic_cast<Altera_ROM*>(dev);
-            Altera_Multiplier18 *mul18 = dynamic_cast<Altera_Multiplier18*>(dev);
-
-            if(lut != nullptr) {
-                return SynthesiseLUTSignals(lut);
-            } else if(rom != nullptr) {
-                return SynthesiseROMSignals(rom);
-            } else if(mul18 != nullptr) {
-                return SynthesiseMultiplierSignals(mul18);
-            } else {
+            switch(dev->kind) {
+            case DEVICE_LUT:
+                return SynthesiseLUTSignals(static_cast<LUT*>(dev));
+            case DEVICE_ALTERA_ROM:
+                return SynthesiseROMSignals(static_cast<Altera_ROM*>(dev));
+            case DEVICE_ALTERA_MULTIPLIER18:
+                return SynthesiseMultiplierSignals(static_cast<Altera_Multiplier18*>(dev));
+            case DEVICE_ALTERA_SHIFTTAPS:
+                return SynthesiseShiftTapsSignals(static_cast<Altera_ShiftTaps*>(dev));
+            default:
                 return "";
             }
         }
@@ -151,7 +148,7 @@ namespace SynthFramework {
                             oper->output->signals[j]->ConnectTo(topLevel->gnd);
                         }
                     }
-                    topLevel->devices.push_back(new Altera_Multiplier18(inputs[0], inputs[1], output, oper->inputs[0]->is_signed, oper->inputs[1]->is_signed));
+                    topLevel->AddDevice(new Altera_Multiplier18(inputs[0], inputs[1], output, oper->inputs[0]->is_signed, oper->inputs[1]->is_signed));
                 } else {
                     //(a + b)(c + d) = ac + ad + bc + bd
                     //(2^18a' + b')(2^18c' + d') = 2^36a'c' + 2^18a'd' + 2^18b'c' + b'd'
@@ -304,33 +301,25 @@ namespace SynthFramework {
              return vhdl.str();
          }
 
-        void CycloneIIITechnology::AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel) {
-            //TODO more accurately
-            double worst_input_tpd = 0;
-            for(auto input : dev->inputPorts) {
-                LogicDevice* outputDriver = input->connectedNet->GetDriver();
-                if(outputDriver != nullptr) {
-                    if(dynamic_cast<LUT*>(outputDriver) != nullptr) {
-                        worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay + 0.15e-9);
-                    } else {
-                        worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay);
-                    }
-                } else {
-                    worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay);
-                }
-            }
+        bool CycloneIIITechnology::IsShiftRegisterSuitable(int width, int depth) {
+            //Shift registers are built from a RAM block, which is only worth using up for enough bits
+            return (depth >= 3) && ((width * depth) >= 256);
+        }
 
-            Altera_Multiplier18 *mul18 = dynamic_cast<Altera_Multiplier18*>(dev);
-            if(mul18 != nullptr) {
-                for(auto op : dev->outputPorts) {
-                    op->connectedNet->delay = worst_input_tpd + 4e-9;
-                }
-            } else {
-                for(auto op : dev->outputPorts) {
-                    op->connectedNet->delay = worst_input_tpd;
-                }
-            }
+        void CycloneIIITechnology::SynthesiseShiftRegister(const vector<Signal*> &D, const vector<Signal*> &Q, int depth, Signal *clock, Signal *enable, LogicDesign *topLevel) {
+            topLevel->AddDevice(new Altera_ShiftTaps(depth, D, clock, enable, Q));
+        }
 
+        bool CycloneIIITechnology::GetBuiltinTimingArc(VendorSpecificDevice *dev, int input, int output, bool lutDriven, double &routingDelay, double &cellDelay) {
+            //TODO more accurately
+            routingDelay = lutDriven ? 0.15e-9 : 0;
+            cellDelay = (dev->kind == DEVICE_ALTERA_MULTIPLIER18) ? 4e-9 : 0;
+            //Outputs of shift registers come from the RAM block
+            return dev->kind != DEVICE_ALTERA_SHIFTTAPS;
+        }
+
+        double CycloneIIITechnology::GetBuiltinOutputDelay(VendorSpecificDevice *dev, int output) {
+            return (dev->kind == DEVICE_ALTERA_SHIFTTAPS) ? 2e-9 : 0;
         }
 
         void CycloneIIITechnology::GenerateAdderChain(Operation *oper, bool isSub, LogicDesign *topLevel, Signal *cin) {
@@ -356,7 +345,7 @@ namespace SynthFramework {
                         Signal *inPin = oper->GetInputSignal(i, j, topLevel);
                         if((i == 1) && isSub) { //need to invert B input for a subtractor
                             Signal *invPin = topLevel->CreateSignal(oper->name + "_invB_" + to_string(j));
-                            topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{inPin}, invPin));
+                            topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{inPin}, invPin));
                             inPins.push_back(invPin);
                         } else {
                             inPins.push_back(inPin);
@@ -370,9 +359,9 @@ namespace SynthFramework {
                     LUT *carry_lut = new LUT(Device_FULLADD_CARRY, inPins, carryOutInt);
                     sum_lut->maxSizeOverride = 3;
                     carry_lut->maxSizeOverride = 3;
-                    topLevel->devices.push_back(sum_lut);
-                    topLevel->devices.push_back(carry_lut);
-                    topLevel->devices.push_back(new Altera_CarrySum(sumOutInt, carryOutInt, outPin, carryOut));
+                    topLevel->AddDevice(sum_lut);
+                    topLevel->AddDevice(carry_lut);
+                    topLevel->AddDevice(new Altera_CarrySum(sumOutInt, carryOutInt, outPin, carryOut));
 
                     carryChain = carryOut;
                 }
@@ -409,6 +398,40 @@ namespace SynthFramework {
         }
 
 
+        string CycloneIIITechnology::SynthesiseShiftTaps(Altera_ShiftTaps *st) {
+            stringstream vhdl;
+            vhdl << "\t" << st->name << "_d <= ";
+            for(int i = st->width - 1; i >= 0; i--) {
+                vhdl << st->inputPorts[i]->connectedNet->name;
+                if(i > 0) vhdl << " & ";
+            }
+            vhdl << ";" << endl;
+            vhdl << "\t" << st->name << " : altshift_taps generic map(" << endl;
+            vhdl << "\t\t\t" << "intended_device_family => \"Cyclone III\"," << endl;
+            vhdl << "\t\t\t" << "lpm_type => \"altshift_taps\"," << endl;
+            vhdl << "\t\t\t" << "number_of_taps => 1," << endl;
+            vhdl << "\t\t\t" << "tap_distance => " << st->depth << "," << endl;
+            vhdl << "\t\t\t" << "width => " << st->width << endl;
+            vhdl << "\t\t) port map(" << endl;
+            vhdl << "\t\t\tclock => " << st->inputPorts[st->width]->connectedNet->name << ", " << endl;
+            if(st->hasEnable) {
+                vhdl << "\t\t\tclken => " << st->inputPorts[st->width + 1]->connectedNet->name << ", " << endl;
+            }
+            vhdl << "\t\t\tshiftin => " << st->name << "_d, " << endl;
+            vhdl << "\t\t\ttaps => " << st->name << "_q);" << endl;
+            for(int i = 0 ; i < st->outputPorts.size(); i++) {
+                vhdl << "\t" << st->outputPorts[i]->connectedNet->name << " <= " << st->name + "_q(" << i << ");" << endl;
+            }
+            return vhdl.str();
+        }
+
+        string CycloneIIITechnology::SynthesiseShiftTapsSignals(Altera_ShiftTaps *st) {
+            stringstream vhdl;
+            vhdl << "\tsignal " << st->name << "_d : std_logic_vector(" << (st->width - 1) << " downto 0);" << endl;
+            vhdl << "\tsignal " << st->name << "_q : std_logic_vector(" << (st->width - 1) << " downto 0);" << endl;
+            return vhdl.str();
+        }
+
         string CycloneIIITechnology::SynthesiseMultiplierSignals(Altera_Multiplier18 *mul) {
             stringstream vhdl;
             vhdl << "\tsignal " << mul->name << "_q : std_logic_vector(35 downto 0);" << endl;
@@ -488,8 +511,9 @@ namespace SynthFramework {
             int ramBitCount = 0;
             int mul9count  = 0;
             for(auto dev : topLevel->devices) {
-                Altera_CarrySum *cs = dynamic_cast<Altera_CarrySum*>(dev);
-                if(cs != nullptr) {
+                switch(dev->kind) {
+                case DEVICE_ALTERA_CARRYSUM: {
+                    Altera_CarrySum *cs = static_cast<Altera_CarrySum*>(dev);
                     //Both LUTs driving a CarrySum are merged into one LE and therefore
                     //only need to be counted once
                     totalLEcount++;
@@ -497,7 +521,7 @@ namespace SynthFramework {
                     for(int i = 0; i < 2; i++) {
                         LogicDevice *drivingDev = cs->inputPorts[i]->connectedNet->GetDriver();
                         if(drivingDev != nullptr) { //port is being driven by a LogicDevice
-                            LUT *drivingLut = dynamic_cast<LUT*>(drivingDev);
+                            LUT *drivingLut = DeviceCast<LUT>(drivingDev);
                             if(drivingLut != nullptr) { //port is being driven by a LUT
                                 if(drivingLut->inputPorts.size() <= 3) {
                                     counted.insert(drivingLut);
@@ -507,36 +531,44 @@ namespace SynthFramework {
                     }
 
                     //Up to one register can also be included
-                    for(auto driven : cs->outputPorts[0]->connectedNet->connectedPorts) {
+                    for(auto driven : cs->outputPorts[0]->connectedNet->fanout) {
                         DeviceInputPort *dip = dynamic_cast<DeviceInputPort*>(driven);
                         if(dip != nullptr) {
-                            FlipFlop *ff = dynamic_cast<FlipFlop*>(dip->device);
-                            if(ff != nullptr) {
-                                counted.insert(ff);
+                            if(dip->device->kind == DEVICE_FLIPFLOP) {
+                                counted.insert(dip->device);
                                 regLEcount++;
                             }
                         }
                     }
-                }
-                Altera_ROM *rom = dynamic_cast<Altera_ROM*>(dev);
-                if(rom != nullptr) {
+                } break;
+                case DEVICE_ALTERA_ROM: {
+                    Altera_ROM *rom = static_cast<Altera_ROM*>(dev);
                     ramBitCount += (rom->width * rom->length);
+                } break;
+                case DEVICE_ALTERA_SHIFTTAPS: {
+                    Altera_ShiftTaps *st = static_cast<Altera_ShiftTaps*>(dev);
+                    ramBitCount += (st->width * st->depth);
+                } break;
+                case DEVICE_ALTERA_MULTIPLIER18:
+                    mul9count += 2; //each 18x18 is two 9x9s
+                    break;
+                default:
+                    break;
                 }
             }
 
             for(auto dev : topLevel->devices) {
                 if(counted.find(dev) == counted.end()) {
-                    LUT *lut = dynamic_cast<LUT*>(dev);
+                    LUT *lut = DeviceCast<LUT>(dev);
                     if(lut != nullptr) {
                         totalLEcount++;
                         combLEcount++;
                         //Up to one register can also be included with a lut
-                        for(auto driven : lut->outputPorts[0]->connectedNet->connectedPorts) {
+                        for(auto driven : lut->outputPorts[0]->connectedNet->fanout) {
                             DeviceInputPort *dip = dynamic_cast<DeviceInputPort*>(driven);
                             if(dip != nullptr) {
-                                FlipFlop *ff = dynamic_cast<FlipFlop*>(dip->device);
-                                if(ff != nullptr) {
-                                    counted.insert(ff);
+                                if(dip->device->kind == DEVICE_FLIPFLOP) {
+                                    counted.insert(dip->device);
                                     regLEcount++;
                                 }
                             }
@@ -549,21 +581,13 @@ namespace SynthFramework {
             //final remaining extra flipflops
             for(auto dev : topLevel->devices) {
                 if(counted.find(dev) == counted.end()) {
-                    FlipFlop *ff = dynamic_cast<FlipFlop*>(dev);
-                    if(ff != nullptr) {
+                    if(dev->kind == DEVICE_FLIPFLOP) {
                         totalLEcount++;
                         regLEcount++;
                     }
                 }
             }
 
-            //count multipliers
-            for(auto dev : topLevel->devices) {
-                Altera_Multiplier18 *mul18 = dynamic_cast<Altera_Multiplier18*>(dev);
-                if(mul18 != nullptr) {
-                    mul9count += 2; //each 18x18 is two 9x9s
-                }
-            }
             stringstream message;
             message << "Cyclone III resource utilisation\n";
             message << "  " <<  totalLEcount << " logic elements\n";
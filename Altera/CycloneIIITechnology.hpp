@@ -23,7 +23,11 @@ namespace SynthFramework {
 
             bool DeviceSpecificSynthesis(Operation *oper, LogicDesign* topLevel);
 
-            void AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel);
+            bool IsShiftRegisterSuitable(int width, int depth);
+            void SynthesiseShiftRegister(const vector<Signal*> &D, const vector<Signal*> &Q, int depth, Signal *clock, Signal *enable, LogicDesign *topLevel);
+
+            bool GetBuiltinTimingArc(VendorSpecificDevice *dev, int input, int output, bool lutDriven, double &routingDelay, double &cellDelay);
+            double GetBuiltinOutputDelay(VendorSpecificDevice *dev, int output);
 
             string PrintResourceUsage(LogicDesign *topLevel);
 
@@ -39,6 +43,8 @@ namespace SynthFramework {
             string SynthesiseROMSignals(Altera_ROM *rom);
             string SynthesiseMultiplier(Altera_Multiplier18 *mul);
             string SynthesiseMultiplierSignals(Altera_Multiplier18 *mul);
+            string SynthesiseShiftTaps(Altera_ShiftTaps *st);
+            string SynthesiseShiftTapsSignals(Altera_ShiftTaps *st);
 
             //Generate adder chain using CARRYSUMs
             void GenerateAdderChain(Operation *oper, bool isSub, LogicDesign *topLevel, Signal *cin = nullptr);
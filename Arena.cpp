@@ -0,0 +1,133 @@
+#include "Arena.hpp"
+#include <new>
+#include <algorithm>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        thread_local Arena *Arena::current = nullptr;
+
+        ArenaObject::~ArenaObject() {
+
+        }
+
+        void *ArenaObject::operator new(size_t size) {
+            Arena *arena = Arena::GetCurrent();
+            if(arena != nullptr) {
+                return arena->Allocate(size);
+            } else {
+                //Not owned by any arena, marked by an empty header
+                char *mem = static_cast<char*>(::operator new(size + sizeof(void*)));
+                *reinterpret_cast<Arena**>(mem) = nullptr;
+                return mem + sizeof(void*);
+            }
+        }
+
+        void ArenaObject::operator delete(void *ptr, size_t size) {
+            if(ptr == nullptr)
+                return;
+            char *mem = static_cast<char*>(ptr) - sizeof(void*);
+            Arena *owner = *reinterpret_cast<Arena**>(mem);
+            if(owner != nullptr) {
+                owner->Free(ptr, size);
+            } else {
+                ::operator delete(mem);
+            }
+        }
+
+        Arena::Arena() {
+            sizeClasses.resize(maxPooledSize / granularity + 1);
+        }
+
+        Arena::~Arena() {
+            DestroyAll();
+        }
+
+        size_t Arena::GetSlotSize(int sizeClass) {
+            return headerSize + sizeClass * granularity;
+        }
+
+        void *Arena::Allocate(size_t size) {
+            bytesInUse += size;
+            if(size > maxPooledSize) {
+                char *mem = static_cast<char*>(::operator new(size + headerSize));
+                *reinterpret_cast<Arena**>(mem) = this;
+                largeObjects.push_back(mem);
+                return mem + headerSize;
+            }
+            int sc = (size + granularity - 1) / granularity;
+            SizeClass &cls = sizeClasses[sc];
+            char *slot;
+            if(cls.freeList != nullptr) {
+                slot = static_cast<char*>(cls.freeList) - headerSize;
+                cls.freeList = *reinterpret_cast<void**>(cls.freeList);
+            } else {
+                if(cls.blocks.empty() || (cls.usedInLastBlock == cls.slotsPerBlock)) {
+                    cls.slotsPerBlock = max<size_t>(blockSize / GetSlotSize(sc), 16);
+                    cls.blocks.push_back(static_cast<char*>(::operator new(cls.slotsPerBlock * GetSlotSize(sc))));
+                    cls.usedInLastBlock = 0;
+                }
+                slot = cls.blocks.back() + cls.usedInLastBlock * GetSlotSize(sc);
+                cls.usedInLastBlock++;
+            }
+            *reinterpret_cast<Arena**>(slot) = this;
+            return slot + headerSize;
+        }
+
+        void Arena::Free(void *ptr, size_t size) {
+            bytesInUse -= size;
+            char *slot = static_cast<char*>(ptr) - headerSize;
+            if(size > maxPooledSize) {
+                largeObjects.erase(find(largeObjects.begin(), largeObjects.end(), slot));
+                ::operator delete(slot);
+                return;
+            }
+            SizeClass &cls = sizeClasses[(size + granularity - 1) / granularity];
+            *reinterpret_cast<Arena**>(slot) = nullptr;
+            *reinterpret_cast<void**>(ptr) = cls.freeList;
+            cls.freeList = ptr;
+        }
+
+        void Arena::DestroyAll() {
+            for(int sc = 0; sc < sizeClasses.size(); sc++) {
+                SizeClass &cls = sizeClasses[sc];
+                for(int i = 0; i < cls.blocks.size(); i++) {
+                    size_t slotCount = (i == cls.blocks.size() - 1) ? cls.usedInLastBlock : cls.slotsPerBlock;
+                    for(size_t j = 0; j < slotCount; j++) {
+                        char *slot = cls.blocks[i] + j * GetSlotSize(sc);
+                        if(*reinterpret_cast<Arena**>(slot) == this) {
+                            reinterpret_cast<ArenaObject*>(slot + headerSize)->~ArenaObject();
+                        }
+                    }
+                    ::operator delete(cls.blocks[i]);
+                }
+                cls.blocks.clear();
+                cls.usedInLastBlock = 0;
+                cls.freeList = nullptr;
+            }
+            for(auto mem : largeObjects) {
+                reinterpret_cast<ArenaObject*>(mem + headerSize)->~ArenaObject();
+                ::operator delete(mem);
+            }
+            largeObjects.clear();
+            bytesInUse = 0;
+        }
+
+        size_t Arena::GetBytesInUse() {
+            return bytesInUse;
+        }
+
+        Arena *Arena::GetCurrent() {
+            return current;
+        }
+
+        ArenaScope::ArenaScope(Arena *arena) {
+            previous = Arena::current;
+            Arena::current = arena;
+        }
+
+        ArenaScope::~ArenaScope() {
+            Arena::current = previous;
+        }
+    }
+}
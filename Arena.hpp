@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    class Arena;
+
+    /*
+    Base class for the objects making up a design (signals, buses, ports, devices, etc)
+    Objects are allocated from the arena made current by an ArenaScope, or from the normal heap if there is none,
+    and are returned to the arena they came from when deleted
+    Destructors of these objects must not access other objects, as an arena may destroy objects in any order
+    */
+    class ArenaObject {
+    public:
+      virtual ~ArenaObject();
+      static void *operator new(size_t size);
+      static void operator delete(void *ptr, size_t size);
+    };
+
+    /*
+    Pool allocator for design objects
+    Memory is taken in large blocks, each holding objects of a single size class, and deleted objects are recycled
+    through a free list for their size class. Objects still alive when the arena is destroyed are destroyed with it,
+    so a whole design can be released in one go
+    */
+    class Arena {
+    public:
+      Arena();
+      ~Arena();
+      //Allocate memory for an object of a given size
+      void *Allocate(size_t size);
+      //Return memory for an object of a given size to the arena
+      void Free(void *ptr, size_t size);
+      //Call the destructor of every object still allocated from the arena and release all memory
+      void DestroyAll();
+      //Return the total size of objects currently allocated from the arena
+      size_t GetBytesInUse();
+
+      //Return the arena objects are currently being allocated from, or nullptr if none
+      static Arena *GetCurrent();
+    private:
+      //Each slot starts with a header holding the owning arena, or nullptr if the slot is free
+      static const size_t headerSize = sizeof(void*);
+      static const size_t granularity = 8;
+      static const size_t maxPooledSize = 512;
+      static const size_t blockSize = 64 * 1024;
+
+      struct SizeClass {
+        vector<char*> blocks;
+        size_t usedInLastBlock = 0; //slots handed out from the last block
+        size_t slotsPerBlock = 0;
+        void *freeList = nullptr; //free slots, linked through their first word after the header
+      };
+      vector<SizeClass> sizeClasses;
+      vector<char*> largeObjects; //objects too big to pool, allocated individually
+      size_t bytesInUse = 0;
+
+      static size_t GetSlotSize(int sizeClass);
+
+      friend class ArenaScope;
+      static thread_local Arena *current;
+    };
+
+    //Makes an arena current for the lifetime of the scope object
+    class ArenaScope {
+    public:
+      ArenaScope(Arena *arena);
+      ~ArenaScope();
+    private:
+      Arena *previous;
+    };
+  }
+}
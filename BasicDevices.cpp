@@ -1,6 +1,8 @@
 #include "BasicDevices.hpp"
 #include "Util.hpp"
 #include "LogicDesign.hpp"
+#include "StructuralHash.hpp"
+#include "BinaryNetlist.hpp"
 #include <typeinfo>
 #include <sstream>
 using namespace std;
@@ -8,7 +10,7 @@ using namespace std;
 namespace SynthFramework {
     namespace Polymer {
          //LUT initialisation values for standard gates
-         map<LUTDeviceType, vector<bool> > LUT::initialContents {
+         map<LUTDeviceType, TruthTable> LUT::initialContents {
             { Device_AND2, vector<bool> {0, 0, 0, 1} },
             { Device_OR2, vector<bool> {0, 1, 1, 1} },
             { Device_XOR2, vector<bool> {0, 1, 1, 0} },
@@ -21,85 +23,42 @@ namespace SynthFramework {
             { Device_FULLADD_CARRY, vector<bool> {0, 0, 0, 1, 0, 1, 1, 1} },
             { Device_MUX2_1, vector<bool> {0, 1, 0, 1, 0, 0, 1, 1} } };
 
-         //LUT related helper functions
-
-         //Return true if a given input has no bearing on the output value
-         bool IsInputRedundant(const vector<bool> &lut, int input) {
-             //in theory only half the checks are needed, but that makes the loop more complicated
-             for(int i = 0; i < lut.size(); i++) {
-                 //compare lut contents at this point with lut contents with input inverted
-                 if(lut[i] != lut[i ^ (1 << input)]) {
-                     return false; //inverting input changes output, thus input not redundant
-                 }
-             }
-             return true;
-         }
-
-         //Create a new LUT content array with one input eliminated and forced to a constant value
-         void EliminateInput(const vector<bool> &initialLut, int input, bool value, vector<bool> &newLut) {
-             //again this loop could in the future be optimised
-             newLut.clear();
-             for(int i = 0; i < initialLut.size(); i++) {
-                 //pick LUT entry only if specified input is equal to value
-                 if(((i & (1 << input)) != 0) == value) {
-                     newLut.push_back(initialLut[i]);
-                 }
-             }
-         }
-
-         LUT::LUT() {
-             name = "lut_" + to_string(lutCount);
-             lutCount++;
+         LUT::LUT() : LogicDevice(DEVICE_LUT) {
+             name = "lut_" + to_string(createdCount[DEVICE_LUT]);
+             createdCount[DEVICE_LUT]++;
          };
 
-         LUT::LUT(LUTDeviceType type, vector<Signal*> inputs, Signal* output) {
-             name = "lut_" + to_string(lutCount);
-             lutCount++;
-             lutContent = initialContents[type];
+         LUT::LUT(LUTDeviceType type, vector<Signal*> inputs, Signal* output) : LogicDevice(DEVICE_LUT) {
+             name = "lut_" + to_string(createdCount[DEVICE_LUT]);
+             createdCount[DEVICE_LUT]++;
+             lutContent = initialContents.at(type);
              for(int i = 0; i < inputs.size(); i++) {
                  DeviceInputPort *inp = new DeviceInputPort();
                  inp->device = this;
                  inp->pin = i;
-                 inp->connectedNet = inputs[i];
-                 inputs[i]->connectedPorts.push_back(inp);
+                 inp->Connect(inputs[i]);
                  inputPorts.push_back(inp);
              }
 
              DeviceOutputPort *outp = new DeviceOutputPort();
              outp->device = this;
              outp->pin = 0;
-             outp->connectedNet = output;
-             output->connectedPorts.push_back(outp);
+             outp->Connect(output);
              outputPorts.push_back(outp);
          }
 
          void LUT::MergeWith(LUT* other, int pin) {
              //Note the inputs from the 'other' LUT are put at the start of this one
-             vector<bool> newContent;
-             for(int i = 0; i < lutContent.size(); i++) {
-                //only processing things when the value of the replaced pin is zero prevents the newContent array being duplicated
-                if((i & (1 << pin)) == 0) {
-                    for(int j = 0; j < other->lutContent.size(); j++) {
-                        //evaluate all input combinations in the other LUT
-                        if(other->lutContent[j]) {
-                            //output of other LUT is high, thus pick from row in this LUT equivalent to i but where pin is high
-                            newContent.push_back(lutContent[i | (1 << pin)]);
-                        } else {
-                            //output of other LUT is low, thus pick from row i where pin is low
-                            newContent.push_back(lutContent[i]);
-                        }
-                    }
-                }
-             }
+             TruthTable newContent = lutContent.Compose(other->lutContent, pin);
              inputPorts[pin]->Disconnect();
+             delete inputPorts[pin];
              inputPorts.erase(inputPorts.begin() + pin);
              //add inputs of 'other' LUT to this one at the start but in the correct order
              for(int i = other->inputPorts.size() - 1; i >= 0; i--) {
                  DeviceInputPort *port = new DeviceInputPort();
                  port->pin = i;
                  port->device = this;
-                 port->connectedNet = other->inputPorts[i]->connectedNet;
-                 other->inputPorts[i]->connectedNet->connectedPorts.push_back(port);
+                 port->Connect(other->inputPorts[i]->connectedNet);
                  inputPorts.insert(inputPorts.begin(), port);
              }
              lutContent = newContent;
@@ -122,11 +81,10 @@ namespace SynthFramework {
                  }
                  if(constantInput != -1) {
                      deviceOptimised = true;
-                     vector<bool> newLutContent;
-                     EliminateInput(lutContent, constantInput, inputVal, newLutContent);
+                     lutContent = lutContent.EliminateInput(constantInput, inputVal);
                      inputPorts[constantInput]->Disconnect();
+                     delete inputPorts[constantInput];
                      inputPorts.erase(inputPorts.begin() + constantInput);
-                     lutContent = newLutContent;
                  }
 
              } while(constantInput != -1);
@@ -134,18 +92,17 @@ namespace SynthFramework {
              do {
                  redundantInput = -1;
                  for(int i = 0; i < inputPorts.size(); i++) {
-                    if(IsInputRedundant(lutContent, i)) {
+                    if(lutContent.IsInputRedundant(i)) {
                         redundantInput = i;
                         break;
                     }
                  }
                  if(redundantInput != -1) {
                      deviceOptimised = true;
-                     vector<bool> newLutContent;
-                     EliminateInput(lutContent, redundantInput, false, newLutContent);
+                     lutContent = lutContent.EliminateInput(redundantInput, false);
                      inputPorts[redundantInput]->Disconnect();
+                     delete inputPorts[redundantInput];
                      inputPorts.erase(inputPorts.begin() + redundantInput);
-                     lutContent = newLutContent;
                  }
 
              } while(redundantInput != -1);
@@ -167,18 +124,11 @@ namespace SynthFramework {
                }
                if(duplicateInput != -1) {
                  PrintMessage(MSG_DEBUG, "inputs " + to_string(firstInput) + " and " + to_string(duplicateInput) + " to ===" + name + "=== are fed from the same net and will be merged");
-                 vector<bool> newContent;
-                 for(int i = 0; i < lutContent.size(); i++) {
-                   //Only pick entries where the two inputs have the same value
-                   bool stateA = ((i & (1 << firstInput)) != 0);
-                   bool stateB = ((i & (1 << duplicateInput)) != 0);
-                   if(stateA == stateB) {
-                     newContent.push_back(lutContent[i]);
-                   }
-                 }
+                 //Only entries where the two inputs have the same value are kept
+                 lutContent = lutContent.MergeInputs(firstInput, duplicateInput);
                  inputPorts[duplicateInput]->Disconnect();
+                 delete inputPorts[duplicateInput];
                  inputPorts.erase(inputPorts.begin() + duplicateInput);
-                 lutContent = newContent;
                }
              } while(duplicateInput != -1);
              if(inputPorts.size() == 0) {
@@ -208,7 +158,7 @@ namespace SynthFramework {
                          for(int i = 0; i < inputPorts.size(); i++) {
                             LogicDevice *drivingDev = inputPorts[i]->connectedNet->GetDriver();
                             if(drivingDev != nullptr) { //port is being driven by a LogicDevice
-                                drivingLut = dynamic_cast<LUT*>(drivingDev);
+                                drivingLut = DeviceCast<LUT>(drivingDev);
                                 if(drivingLut != nullptr) { //port is being driven by a LUT
                                     int maxSize = topLevel->technology->GetLUTInputCount();
                                     if(maxSizeOverride != -1) {
@@ -242,7 +192,7 @@ namespace SynthFramework {
          string LUT::GenerateSOP(const vector<string>& pinNames) {
              stringstream sop;
              bool firstTerm = true;
-             for(int i = 0; i < lutContent.size(); i++) {
+             for(int i = 0; i < lutContent.GetSize(); i++) {
                  if(lutContent[i]) {
                      if(!firstTerm) {
                          sop << " or ";
@@ -270,49 +220,108 @@ namespace SynthFramework {
          }
 
          bool LUT::IsEquivalentTo(LogicDevice* other) {
-             LUT *lut = dynamic_cast<LUT*>(other);
+             LUT *lut = DeviceCast<LUT>(other);
              if(lut != nullptr) {
                  if(lut->inputPorts.size() != inputPorts.size()) return false;
-                 //At some point this should be improved to consider the case where pins are the
-                 //same but in a different order
-                 for(int i = 0; i < inputPorts.size(); i++) {
-                     if(inputPorts[i]->connectedNet != lut->inputPorts[i]->connectedNet)
-                        return false;
-                 }
+                 //LUTs restricted in size by carry logic must not be replaced by unrestricted ones
+                 if(maxSizeOverride != lut->maxSizeOverride) return false;
+                 vector<Signal*> nets, otherNets;
+                 TruthTable content, otherContent;
+                 GetCanonicalForm(nets, content);
+                 lut->GetCanonicalForm(otherNets, otherContent);
+                 return (nets == otherNets) && (content == otherContent);
+             } else {
+                 return false;
+             }
+         }
+
+         bool LUT::GetStructuralHash(size_t &hash) {
+             vector<Signal*> nets;
+             TruthTable content;
+             GetCanonicalForm(nets, content);
+             hash = HashCombine(0x4C5554, content.Hash());
+             hash = HashCombine(hash, maxSizeOverride);
+             for(auto net : nets) {
+                 hash = HashCombine(hash, reinterpret_cast<size_t>(net));
+             }
+             return true;
+         }
 
-                 for(int i = 0; i < lutContent.size(); i++) {
-                     if(lutContent[i] != lut->lutContent[i])
-                        return false;
+         void LUT::GetCanonicalForm(vector<Signal*> &nets, TruthTable &content) {
+             nets.clear();
+             for(auto inp : inputPorts) {
+                 nets.push_back(inp->connectedNet);
+             }
+             content = lutContent;
+             //Selection sort, as LUTs have few inputs and each exchange of pins is a swap of truth table inputs
+             for(int i = 0; i < int(nets.size()); i++) {
+                 int first = i;
+                 for(int j = i + 1; j < int(nets.size()); j++) {
+                     if(less<Signal*>()(nets[j], nets[first])) {
+                         first = j;
+                     }
+                 }
+                 if(first != i) {
+                     swap(nets[i], nets[first]);
+                     content.SwapInputs(i, first);
                  }
+             }
+         }
 
-                 return true;
-             } else {
-                 return false;
+         LogicDevice *LUT::Clone() {
+             LUT *copy = new LUT(*this);
+             copy->ClearCloneState();
+             return copy;
+         }
+
+         void LUT::WriteConfig(BinaryWriter &out) {
+             //Entries are packed 64 to a word
+             out.WriteInt(lutContent.GetInputCount());
+             for(int i = 0; i < lutContent.GetSize(); i += 64) {
+                 uint64_t word = 0;
+                 for(int j = 0; (j < 64) && ((i + j) < lutContent.GetSize()); j++) {
+                     if(lutContent.Get(i + j)) {
+                         word |= (1ULL << j);
+                     }
+                 }
+                 out.WriteU64(word);
              }
+             out.WriteInt(maxSizeOverride);
          }
-         int LUT::lutCount;
 
+         void LUT::ReadConfig(BinaryReader &in) {
+             int inputCount = in.ReadInt();
+             if((inputCount < 0) || (inputCount > 30)) {
+                 PrintMessage(MSG_ERROR, "invalid LUT in binary netlist");
+             }
+             lutContent = TruthTable(inputCount);
+             for(int i = 0; i < lutContent.GetSize(); i += 64) {
+                 uint64_t word = in.ReadU64();
+                 for(int j = 0; (j < 64) && ((i + j) < lutContent.GetSize()); j++) {
+                     lutContent.Set(i + j, (word >> j) & 1);
+                 }
+             }
+             maxSizeOverride = in.ReadInt();
+         }
 
-         FlipFlop::FlipFlop() {
-             name = "ff_" + to_string(ffCount);
-             ffCount++;
+         FlipFlop::FlipFlop() : LogicDevice(DEVICE_FLIPFLOP) {
+             name = "ff_" + to_string(createdCount[DEVICE_FLIPFLOP]);
+             createdCount[DEVICE_FLIPFLOP]++;
          }
 
-         FlipFlop::FlipFlop(Signal *D, Signal *CLK, Signal *Q, Signal *enable, Signal *reset)  {
-             name = "ff_" + to_string(ffCount);
-             ffCount++;
+         FlipFlop::FlipFlop(Signal *D, Signal *CLK, Signal *Q, Signal *enable, Signal *reset) : LogicDevice(DEVICE_FLIPFLOP) {
+             name = "ff_" + to_string(createdCount[DEVICE_FLIPFLOP]);
+             createdCount[DEVICE_FLIPFLOP]++;
              DeviceInputPort *dp = new DeviceInputPort();
              dp->device = this;
              dp->pin = 0;
-             dp->connectedNet = D;
-             D->connectedPorts.push_back(dp);
+             dp->Connect(D);
              inputPorts.push_back(dp);
 
              DeviceInputPort *cp = new DeviceInputPort();
              cp->device = this;
              cp->pin = 1;
-             cp->connectedNet = CLK;
-             CLK->connectedPorts.push_back(cp);
+             cp->Connect(CLK);
              inputPorts.push_back(cp);
 
              int resetPin = 2;
@@ -323,8 +332,7 @@ namespace SynthFramework {
                  DeviceInputPort *ep = new DeviceInputPort();
                  ep->device = this;
                  ep->pin = 2;
-                 ep->connectedNet = enable;
-                 enable->connectedPorts.push_back(ep);
+                 ep->Connect(enable);
                  inputPorts.push_back(ep);
              } else {
                  hasEnable = false;
@@ -335,8 +343,7 @@ namespace SynthFramework {
                  DeviceInputPort *rp = new DeviceInputPort();
                  rp->device = this;
                  rp->pin = resetPin;
-                 rp->connectedNet = reset;
-                 reset->connectedPorts.push_back(rp);
+                 rp->Connect(reset);
                  inputPorts.push_back(rp);
              } else {
                  hasReset = false;
@@ -345,15 +352,14 @@ namespace SynthFramework {
              DeviceOutputPort *qp = new DeviceOutputPort();
              qp->device = this;
              qp->pin = 0;
-             qp->connectedNet = Q;
-             Q->connectedPorts.push_back(qp);
+             qp->Connect(Q);
              outputPorts.push_back(qp);
          }
 
          bool FlipFlop::IsEquivalentTo(LogicDevice* other) {
-             FlipFlop *ff = dynamic_cast<FlipFlop*>(other);
+             FlipFlop *ff = DeviceCast<FlipFlop>(other);
              if(ff != nullptr) {
-                if((hasReset != ff->hasReset) || (hasEnable != ff->hasEnable))
+                if((hasReset != ff->hasReset) || (hasEnable != ff->hasEnable) || (isShift != ff->isShift))
                     return false;
 
                 for(int i = 0; i < inputPorts.size(); i++) {
@@ -367,21 +373,59 @@ namespace SynthFramework {
              }
          }
 
-         ConstantDevice::ConstantDevice() {
+         bool FlipFlop::GetStructuralHash(size_t &hash) {
+             hash = HashCombine(0x4646, (hasEnable ? 1 : 0) | (hasReset ? 2 : 0) | (isShift ? 4 : 0));
+             for(auto inp : inputPorts) {
+                 hash = HashCombine(hash, reinterpret_cast<size_t>(inp->connectedNet.Get()));
+             }
+             return true;
+         }
+
+         LogicDevice *FlipFlop::Clone() {
+             FlipFlop *copy = new FlipFlop(*this);
+             copy->ClearCloneState();
+             return copy;
+         }
+
+         void FlipFlop::WriteConfig(BinaryWriter &out) {
+             out.WriteBool(hasEnable);
+             out.WriteBool(hasReset);
+             out.WriteBool(isShift);
+         }
+
+         void FlipFlop::ReadConfig(BinaryReader &in) {
+             hasEnable = in.ReadBool();
+             hasReset = in.ReadBool();
+             isShift = in.ReadBool();
+         }
+
+         ConstantDevice::ConstantDevice() : LogicDevice(DEVICE_CONSTANT) {
 
          }
 
-         ConstantDevice::ConstantDevice(Signal *sig, bool _value) {
+         ConstantDevice::ConstantDevice(Signal *sig, bool _value) : LogicDevice(DEVICE_CONSTANT) {
              DeviceOutputPort *cp = new DeviceOutputPort();
              cp->device = this;
              cp->pin = 0;
-             cp->connectedNet = sig;
-             sig->connectedPorts.push_back(cp);
-             outputPorts.push_back(cp);
+             //The value must be set first, as the net caches the state of a constant driver
              value = _value;
+             cp->Connect(sig);
+             outputPorts.push_back(cp);
+         }
+
+         LogicDevice *ConstantDevice::Clone() {
+             ConstantDevice *copy = new ConstantDevice(*this);
+             copy->ClearCloneState();
+             return copy;
          }
 
-         int FlipFlop::ffCount;
+         void ConstantDevice::WriteConfig(BinaryWriter &out) {
+             out.WriteBool(value);
+         }
+
+         void ConstantDevice::ReadConfig(BinaryReader &in) {
+             value = in.ReadBool();
+         }
 
     }
 }
@@ -3,6 +3,7 @@
 #include <string>
 #include <map>
 #include "LogicDevice.hpp"
+#include "TruthTable.hpp"
 using namespace std;
 
 namespace SynthFramework {
@@ -27,12 +28,17 @@ namespace SynthFramework {
      public:
        //Initialise an empty LUT
        LUT();
+       static bool IsKind(DeviceKind k) { return k == DEVICE_LUT; };
        //Initialise a LUT from a standard device, and given input and output signals
        LUT(LUTDeviceType type, vector<Signal*> inputs, Signal* output);
        //The contents of the LUT, one entry for each input permutation
-       vector<bool> lutContent;
+       TruthTable lutContent;
        //Returns whether or not two LUTs are logically equivalent
        bool IsEquivalentTo(LogicDevice* other);
+       bool GetStructuralHash(size_t &hash);
+       LogicDevice *Clone();
+       void WriteConfig(BinaryWriter &out);
+       void ReadConfig(BinaryReader &in);
        //Move another LUT into the current one
        void MergeWith(LUT* other, int pin);
 
@@ -44,8 +50,10 @@ namespace SynthFramework {
        //This forces the maximum size of the LUT, used due to restrictions in Altera's carry logic
        int maxSizeOverride = -1;
     private:
-       static map<LUTDeviceType, vector<bool> > initialContents;
-       static int lutCount;
+       static map<LUTDeviceType, TruthTable> initialContents;
+       //Find the nets driving the inputs sorted into a fixed order, and the contents with the inputs in that order, so
+       //that LUTs which only differ in the order of their pins compare as equivalent
+       void GetCanonicalForm(vector<Signal*> &nets, TruthTable &content);
      };
 
      /*
@@ -56,6 +64,7 @@ namespace SynthFramework {
      class FlipFlop : public LogicDevice {
      public:
        FlipFlop();
+       static bool IsKind(DeviceKind k) { return k == DEVICE_FLIPFLOP; };
        //Set enable and reset to nullptr if not needed
        FlipFlop(Signal *D, Signal *CLK, Signal *Q, Signal *enable = nullptr, Signal *reset = nullptr);
 
@@ -63,10 +72,12 @@ namespace SynthFramework {
        bool hasReset = false;
 
        bool IsEquivalentTo(LogicDevice* other);
+       bool GetStructuralHash(size_t &hash);
+       LogicDevice *Clone();
+       void WriteConfig(BinaryWriter &out);
+       void ReadConfig(BinaryReader &in);
 
        bool isShift = false; //If true then flipflop is not counted for latency purposes
-    private:
-       static int ffCount;
      };
 
      /*
@@ -86,7 +97,11 @@ namespace SynthFramework {
      class ConstantDevice : public LogicDevice {
      public:
        ConstantDevice();
+       static bool IsKind(DeviceKind k) { return k == DEVICE_CONSTANT; };
        ConstantDevice(Signal *sig, bool _value);
+       LogicDevice *Clone();
+       void WriteConfig(BinaryWriter &out);
+       void ReadConfig(BinaryReader &in);
        bool value = false;
      };
   }
@@ -0,0 +1,195 @@
+#include "BinaryNetlist.hpp"
+#include "BasicDevices.hpp"
+#include "Altera/AlteraDevices.hpp"
+#include "Xilinx/XilinxDevices.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        void BinaryWriter::WriteBytes(const void *data, size_t length) {
+            const char *bytes = static_cast<const char*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + length);
+        }
+
+        void BinaryWriter::WriteInt(int32_t value) {
+            uint32_t zigzag = (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+            while(zigzag >= 0x80) {
+                buffer.push_back(char((zigzag & 0x7F) | 0x80));
+                zigzag >>= 7;
+            }
+            buffer.push_back(char(zigzag));
+        }
+
+        void BinaryWriter::WriteU64(uint64_t value) {
+            WriteBytes(&value, sizeof(value));
+        }
+
+        void BinaryWriter::WriteDouble(double value) {
+            WriteBytes(&value, sizeof(value));
+        }
+
+        void BinaryWriter::WriteBool(bool value) {
+            char c = value ? 1 : 0;
+            WriteBytes(&c, 1);
+        }
+
+        void BinaryWriter::WriteString(const string &value) {
+            WriteInt(value.size());
+            WriteBytes(value.data(), value.size());
+        }
+
+        const vector<char> &BinaryWriter::GetData() const {
+            return buffer;
+        }
+
+        bool BinaryWriter::SaveToFile(string filename) const {
+            string tempName = filename + ".tmp" + to_string(getpid());
+            ofstream out(tempName, ios::binary);
+            if(!out.is_open()) {
+                return false;
+            }
+            out.write(buffer.data(), buffer.size());
+            out.close();
+            if(out.fail() || (rename(tempName.c_str(), filename.c_str()) != 0)) {
+                remove(tempName.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        BinaryReader::BinaryReader(const char *_begin, const char *_end) {
+            pos = _begin;
+            end = _end;
+        }
+
+        bool BinaryReader::ReadBytes(void *data, size_t length) {
+            if(!valid || (size_t(end - pos) < length)) {
+                valid = false;
+                memset(data, 0, length);
+                return false;
+            }
+            memcpy(data, pos, length);
+            pos += length;
+            return true;
+        }
+
+        int32_t BinaryReader::ReadInt() {
+            uint32_t zigzag = 0;
+            for(int shift = 0; ; shift += 7) {
+                if(!valid || (pos >= end) || (shift > 28)) {
+                    valid = false;
+                    return 0;
+                }
+                uint8_t byte = *pos;
+                pos++;
+                zigzag |= uint32_t(byte & 0x7F) << shift;
+                if((byte & 0x80) == 0)
+                    break;
+            }
+            return int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+        }
+
+        uint64_t BinaryReader::ReadU64() {
+            uint64_t value;
+            ReadBytes(&value, sizeof(value));
+            return value;
+        }
+
+        double BinaryReader::ReadDouble() {
+            double value;
+            ReadBytes(&value, sizeof(value));
+            return value;
+        }
+
+        bool BinaryReader::ReadBool() {
+            char c;
+            ReadBytes(&c, 1);
+            return c != 0;
+        }
+
+        string BinaryReader::ReadString() {
+            int32_t length = ReadInt();
+            if(!valid || (length < 0) || (size_t(end - pos) < size_t(length))) {
+                valid = false;
+                return "";
+            }
+            string value(pos, length);
+            pos += length;
+            return value;
+        }
+
+        bool BinaryReader::IsValid() const {
+            return valid;
+        }
+
+        const char *BinaryReader::GetPosition() const {
+            return pos;
+        }
+
+        size_t BinaryReader::GetRemaining() const {
+            return end - pos;
+        }
+
+        static const char netlistMagic[4] = {'P', 'L', 'Y', 'N'};
+
+        void WriteBinaryNetlist(BinaryWriter &out, int32_t phase, const BinaryWriter &contents) {
+            out.WriteBytes(netlistMagic, sizeof(netlistMagic));
+            out.WriteInt(BinaryNetlistVersion);
+            out.WriteInt(phase);
+            out.WriteU64(HashBytes(HashOffsetBasis, contents.GetData().data(), contents.GetData().size()));
+            out.WriteBytes(contents.GetData().data(), contents.GetData().size());
+        }
+
+        bool ReadBinaryNetlistHeader(BinaryReader &in, int32_t &phase) {
+            if((in.GetRemaining() < sizeof(netlistMagic)) || (memcmp(in.GetPosition(), netlistMagic, sizeof(netlistMagic)) != 0)) {
+                return false;
+            }
+            char magic[sizeof(netlistMagic)];
+            in.ReadBytes(magic, sizeof(magic));
+            int32_t version = in.ReadInt();
+            phase = in.ReadInt();
+            uint64_t checksum = in.ReadU64();
+            return in.IsValid() && (version == BinaryNetlistVersion) &&
+                (HashBytes(HashOffsetBasis, in.GetPosition(), in.GetRemaining()) == checksum);
+        }
+
+        LogicDevice *CreateDeviceOfKind(DeviceKind kind) {
+            switch(kind) {
+            case DEVICE_LUT:
+                return new LUT();
+            case DEVICE_FLIPFLOP:
+                return new FlipFlop();
+            case DEVICE_CONSTANT:
+                return new ConstantDevice();
+            case DEVICE_XILINX_CARRY4:
+                return new Xilinx_Carry4();
+            case DEVICE_XILINX_DSP48MUL:
+                return new Xilinx_DSP48Mul();
+            case DEVICE_ALTERA_CARRYSUM:
+                return new Altera_CarrySum();
+            case DEVICE_ALTERA_ROM:
+                return new Altera_ROM();
+            case DEVICE_ALTERA_MULTIPLIER18:
+                return new Altera_Multiplier18();
+            case DEVICE_XILINX_SRL:
+                return new Xilinx_SRL();
+            case DEVICE_ALTERA_SHIFTTAPS:
+                return new Altera_ShiftTaps();
+            default:
+                return nullptr;
+            }
+        }
+
+        uint64_t HashBytes(uint64_t hash, const void *data, size_t length) {
+            const unsigned char *bytes = static_cast<const unsigned char*>(data);
+            for(size_t i = 0; i < length; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "LogicDevice.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    /*
+    Binary netlists hold a design at some point in the flow, so that it can be loaded again without repeating the
+    work done so far. Integers are stored as variable length values, so that the many small ids in a netlist take a
+    byte or two each. Other values are stored in the byte order of the machine that wrote them, so files are not
+    portable between architectures
+    */
+
+    //Version of the binary netlist format, which must be changed whenever the format or the result of synthesis changes
+    const int32_t BinaryNetlistVersion = 7;
+
+    //Builds the contents of a binary netlist in memory
+    class BinaryWriter {
+    public:
+      //Integers are written zigzag encoded, 7 bits per byte, so that small negative values are also short
+      void WriteInt(int32_t value);
+      void WriteU64(uint64_t value);
+      void WriteDouble(double value);
+      void WriteBool(bool value);
+      void WriteString(const string &value);
+      void WriteBytes(const void *data, size_t length);
+      const vector<char> &GetData() const;
+      //Write the contents to a file, returning false on failure. A temporary file is renamed into place, so that
+      //other processes never see a partially written file
+      bool SaveToFile(string filename) const;
+    private:
+      vector<char> buffer;
+    };
+
+    //Reads values written by a BinaryWriter. Reading beyond the end of the data doesn't throw, but marks the reader
+    //as failed and returns zero values
+    class BinaryReader {
+    public:
+      BinaryReader(const char *_begin, const char *_end);
+      int32_t ReadInt();
+      uint64_t ReadU64();
+      double ReadDouble();
+      bool ReadBool();
+      string ReadString();
+      bool ReadBytes(void *data, size_t length);
+      //Returns false if any read has gone beyond the end of the data
+      bool IsValid() const;
+      //Return the data that has not yet been read
+      const char *GetPosition() const;
+      size_t GetRemaining() const;
+    private:
+      const char *pos, *end;
+      bool valid = true;
+    };
+
+    //Write a binary netlist file header, followed by the contents of another writer. The header holds the format
+    //version, the point in the flow the netlist was saved at and a checksum of the contents
+    void WriteBinaryNetlist(BinaryWriter &out, int32_t phase, const BinaryWriter &contents);
+    //Check the header of a binary netlist, leaving the reader at the start of the contents. Returns false if the data
+    //is not a binary netlist, is from a different version or is damaged
+    bool ReadBinaryNetlistHeader(BinaryReader &in, int32_t &phase);
+
+    //Create a device of a given kind with no ports, ready for its configuration to be read. Returns nullptr if
+    //devices of that kind can't be stored in a binary netlist
+    LogicDevice *CreateDeviceOfKind(DeviceKind kind);
+
+    //64-bit FNV-1a hash, used to identify the inputs to synthesis
+    const uint64_t HashOffsetBasis = 14695981039346656037ULL;
+    uint64_t HashBytes(uint64_t hash, const void *data, size_t length);
+  }
+}
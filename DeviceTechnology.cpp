@@ -0,0 +1,132 @@
+#include "DeviceTechnology.hpp"
+#include "LogicDesign.hpp"
+#include "Util.hpp"
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        DeviceTechnology::DeviceTechnology() {
+            corners.resize(1);
+            corners[0].name = "default";
+        }
+
+        int DeviceTechnology::GetCornerCount() {
+            return corners.size();
+        }
+
+        string DeviceTechnology::GetCornerName(int corner) {
+            return corners[corner].name;
+        }
+
+        bool DeviceTechnology::AddCorner(string name, string filename) {
+            unique_ptr<TimingModel> model(new TimingModel());
+            if(!model->Load(filename)) {
+                return false;
+            }
+            for(auto &corner : corners) {
+                if(corner.name == name) {
+                    corner.timingModel = move(model);
+                    return true;
+                }
+            }
+            if(corners.size() >= MaxTimingCorners) {
+                PrintMessage(MSG_ERROR, "at most " + to_string(MaxTimingCorners) + " delay corners are supported");
+            }
+            corners.resize(corners.size() + 1);
+            corners.back().name = name;
+            corners.back().timingModel = move(model);
+            return true;
+        }
+
+        bool DeviceTechnology::LoadTimingModel(string filename) {
+            return AddCorner(corners[0].name, filename);
+        }
+
+        double DeviceTechnology::GetLUTPinDelay(LUT *lut, int pin, int corner) {
+            const TimingModel *model = corners[corner].timingModel.get();
+            double delay;
+            if((model != nullptr) && model->GetLUTPinDelay(pin, delay)) {
+                return delay;
+            }
+            return GetLUTTpd(lut);
+        }
+
+        double DeviceTechnology::GetRoutingDelay(Signal *net, int corner) {
+            LogicDevice *driver = net->GetDriver();
+            return GetRoutingDelay((driver != nullptr) && (driver->kind == DEVICE_LUT), net->GetFanout(), corner);
+        }
+
+        double DeviceTechnology::GetRoutingDelay(bool lutDriven, int fanout, int corner) {
+            if(!lutDriven) {
+                return 0;
+            }
+            const TimingModel *model = corners[corner].timingModel.get();
+            double delay;
+            if((model != nullptr) && model->GetRoutingDelay(fanout, delay)) {
+                return delay;
+            }
+            return GetRoutingDelay_LUT_LUT();
+        }
+
+        double DeviceTechnology::GetClockToOutDelay(int corner) {
+            const TimingModel *model = corners[corner].timingModel.get();
+            double delay;
+            if((model != nullptr) && model->GetClockToOut(delay)) {
+                return delay;
+            }
+            return GetFFTpd();
+        }
+
+        double DeviceTechnology::GetSetupTime(int corner) {
+            const TimingModel *model = corners[corner].timingModel.get();
+            double delay;
+            if((model != nullptr) && model->GetSetupTime(delay)) {
+                return delay;
+            }
+            return GetFFSetupTime();
+        }
+
+        bool DeviceTechnology::GetTimingArc(VendorSpecificDevice *dev, int input, int output, int corner, double &routingDelay, double &cellDelay) {
+            Signal *net = dev->inputPorts[input]->connectedNet;
+            LogicDevice *driver = net->GetDriver();
+            return GetTimingArc(dev, input, output, corner, (driver != nullptr) && (driver->kind == DEVICE_LUT), net->GetFanout(), routingDelay, cellDelay);
+        }
+
+        bool DeviceTechnology::GetTimingArc(VendorSpecificDevice *dev, int input, int output, int corner, bool lutDriven, int fanout, double &routingDelay, double &cellDelay) {
+            if(!GetBuiltinTimingArc(dev, input, output, lutDriven, routingDelay, cellDelay)) {
+                return false;
+            }
+            const TimingModel *model = corners[corner].timingModel.get();
+            if(model != nullptr) {
+                if(lutDriven) {
+                    model->GetRoutingDelay(fanout, routingDelay);
+                }
+                model->GetArcDelay(dev->kind, input, output, cellDelay);
+            }
+            return true;
+        }
+
+        void DeviceTechnology::AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel) {
+            for(int c = 0; c < corners.size(); c++) {
+                const TimingModel *model = corners[c].timingModel.get();
+                for(int j = 0; j < dev->outputPorts.size(); j++) {
+                    bool hasArc = false;
+                    double worst_tpd = 0;
+                    for(int i = 0; i < dev->inputPorts.size(); i++) {
+                        double routingDelay, cellDelay;
+                        if(GetTimingArc(dev, i, j, c, routingDelay, cellDelay)) {
+                            worst_tpd = max(worst_tpd, dev->inputPorts[i]->connectedNet->delay[c] + routingDelay + cellDelay);
+                            hasArc = true;
+                        }
+                    }
+                    if(!hasArc) {
+                        if((model == nullptr) || !model->GetOutputDelay(dev->kind, j, worst_tpd)) {
+                            worst_tpd = GetBuiltinOutputDelay(dev, j);
+                        }
+                    }
+                    dev->outputPorts[j]->connectedNet->delay[c] = worst_tpd;
+                }
+            }
+        }
+    }
+}
@@ -2,7 +2,9 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 #include "BasicDevices.hpp"
+#include "TimingModel.hpp"
 using namespace std;
 namespace SynthFramework {
   namespace Polymer {
@@ -15,6 +17,9 @@ namespace SynthFramework {
     */
     class DeviceTechnology {
     public:
+      DeviceTechnology();
+      virtual ~DeviceTechnology() {};
+
       //Capability related
 
       //Return the number of inputs a native LUT has
@@ -30,6 +35,7 @@ namespace SynthFramework {
       virtual string GenerateDeviceSignals(LogicDevice* dev) = 0;
       //Timing related
 
+      //Built in delays of the technology, used unless a timing model has been loaded that gives the delay
       //Return the propagation delay for a LUT
       virtual double GetLUTTpd(LUT* lut) = 0;
       //Return the routing delay for a intra-LUT connection
@@ -46,15 +52,61 @@ namespace SynthFramework {
       //It returns true if device-specific synthesis is performed
       virtual bool DeviceSpecificSynthesis(Operation *oper, LogicDesign* topLevel) = 0;
 
-      //Analyse timing for a vendor specific device
-      virtual void AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel) = 0;
+      //Chains of flip flops sharing a clock and enable may be replaced by dedicated shift register resources once the
+      //design is pipelined. Chains of the same depth are grouped, so that each bit of a bus can share one device
+      //Returns true if a group of width chains, each delaying a signal by depth cycles, is worth replacing
+      virtual bool IsShiftRegisterSuitable(int width, int depth) = 0;
+      //Create devices delaying each signal in D by depth cycles to the signal in Q of the same index. enable is
+      //nullptr if the chains are always enabled
+      virtual void SynthesiseShiftRegister(const vector<Signal*> &D, const vector<Signal*> &Q, int depth, Signal *clock, Signal *enable, LogicDesign *topLevel) = 0;
+
+      //Return the built in delay from an input of a vendor specific device to an output, split into the routing delay
+      //to the input, given whether it is driven by a LUT, and the delay through the device. Returns false if the output
+      //doesn't depend on the input within the same clock cycle
+      virtual bool GetBuiltinTimingArc(VendorSpecificDevice *dev, int input, int output, bool lutDriven, double &routingDelay, double &cellDelay) = 0;
+      //Return the built in delay of an output of a vendor specific device that doesn't depend on any input, such as
+      //a registered output
+      virtual double GetBuiltinOutputDelay(VendorSpecificDevice *dev, int output) = 0;
+
+      //Timing is analysed at every delay corner at once, such as for slow and fast silicon. Corner 0 uses the built in
+      //delays, and each further corner uses its own timing model
+      int GetCornerCount();
+      string GetCornerName(int corner);
+      //Add a corner, or replace the timing model of an existing one. Returns false if the model could not be opened
+      bool AddCorner(string name, string filename);
+      //Load a timing model for corner 0, which overrides the built in delays it gives. Returns false if it could not
+      //be opened
+      bool LoadTimingModel(string filename);
+      //Delays used for timing analysis at a corner, from its timing model if it gives them and otherwise built in
+      //Return the delay from an input of a LUT to its output
+      double GetLUTPinDelay(LUT *lut, int pin, int corner);
+      //Return the routing delay from the driver of a net to the inputs it drives. Only nets driven by LUTs have a
+      //routing delay, which may depend on the fanout of the net
+      double GetRoutingDelay(Signal *net, int corner);
+      //Return the routing delay a net would have if it had the given driver kind and fanout
+      double GetRoutingDelay(bool lutDriven, int fanout, int corner);
+      double GetClockToOutDelay(int corner);
+      double GetSetupTime(int corner);
+      //Return the delay from an input of a vendor specific device to an output, or false if there is no such path.
+      //The timing model may change the delay of paths, but not which paths there are
+      bool GetTimingArc(VendorSpecificDevice *dev, int input, int output, int corner, double &routingDelay, double &cellDelay);
+      //As above, but with the routing delay for an input net with the given driver kind and fanout
+      bool GetTimingArc(VendorSpecificDevice *dev, int input, int output, int corner, bool lutDriven, int fanout, double &routingDelay, double &cellDelay);
+      //Analyse timing for a vendor specific device, setting the delay of each output at every corner from those of
+      //its inputs
+      void AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel);
       //Print resource utilisation summary to the console
       virtual string PrintResourceUsage(LogicDesign *topLevel) = 0;
 
       //Process a device-specific constraint
       //Given a array representing the entire constraint line split by spaces, indices 1 and up being important
       virtual void SetDeviceConstraint(const vector<string>& line) = 0;
-
+    private:
+      struct Corner {
+        string name;
+        unique_ptr<TimingModel> timingModel; //nullptr if the corner only uses built in delays
+      };
+      vector<Corner> corners;
     };
   }
 }
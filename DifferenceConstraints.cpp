@@ -0,0 +1,233 @@
+#include "DifferenceConstraints.hpp"
+#include <queue>
+#include <limits>
+#include <algorithm>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        static const int64_t infiniteCapacity = numeric_limits<int64_t>::max() / 4;
+
+        DifferenceConstraints::DifferenceConstraints(int _variableCount, int64_t _range) {
+            variableCount = _variableCount;
+            range = _range;
+            weights.assign(variableCount, 0);
+        }
+
+        int DifferenceConstraints::GetVariableCount() const {
+            return variableCount;
+        }
+
+        int DifferenceConstraints::AddVariable() {
+            weights.push_back(0);
+            return variableCount++;
+        }
+
+        void DifferenceConstraints::AddConstraint(int a, int b, int64_t bound) {
+            Constraint constraint = {a, b, bound};
+            constraints.push_back(constraint);
+        }
+
+        void DifferenceConstraints::AddWeight(int var, int64_t weight) {
+            weights[var] += weight;
+        }
+
+        void DifferenceConstraints::BuildGraph() {
+            //The constraint x[a] - x[b] <= bound becomes an arc from b to a with the bound as its cost. The range of
+            //each variable is given by a pair of constraints to and from variable 0
+            vector<Constraint> all = constraints;
+            for(int v = 1; v < variableCount; v++) {
+                Constraint upper = {v, 0, range}, lower = {0, v, range};
+                all.push_back(upper);
+                all.push_back(lower);
+            }
+            arcStart.assign(variableCount + 1, 0);
+            for(auto &c : all) {
+                arcStart[c.b + 1]++;
+                arcStart[c.a + 1]++;
+            }
+            for(int v = 0; v < variableCount; v++) {
+                arcStart[v + 1] += arcStart[v];
+            }
+            arcs.resize(arcStart[variableCount]);
+            arcReverse.resize(arcs.size());
+            vector<uint32_t> next(arcStart.begin(), arcStart.end() - 1);
+            for(auto &c : all) {
+                uint32_t forward = next[c.b]++, reverse = next[c.a]++;
+                Arc f = {c.a, c.bound, infiniteCapacity}, r = {c.b, -c.bound, 0};
+                arcs[forward] = f;
+                arcs[reverse] = r;
+                arcReverse[forward] = reverse;
+                arcReverse[reverse] = forward;
+            }
+        }
+
+        bool DifferenceConstraints::FindFeasible() {
+            //Bellman-Ford with a queue of the variables changed, starting from all variables at 0. A variable changed
+            //more times than there are variables must be on a negative cycle
+            potential.assign(variableCount, 0);
+            vector<int> updates(variableCount, 0);
+            vector<bool> queued(variableCount, true);
+            queue<int> pending;
+            for(int v = 0; v < variableCount; v++) {
+                pending.push(v);
+            }
+            while(!pending.empty()) {
+                int v = pending.front();
+                pending.pop();
+                queued[v] = false;
+                for(uint32_t i = arcStart[v]; i < arcStart[v + 1]; i++) {
+                    const Arc &arc = arcs[i];
+                    if((arc.capacity > 0) && (potential[v] + arc.cost < potential[arc.to])) {
+                        potential[arc.to] = potential[v] + arc.cost;
+                        if(!queued[arc.to]) {
+                            if(++updates[arc.to] > variableCount)
+                                return false;
+                            queued[arc.to] = true;
+                            pending.push(arc.to);
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        int64_t DifferenceConstraints::ReducedCost(int from, const Arc &arc) const {
+            return arc.cost + potential[from] - potential[arc.to];
+        }
+
+        bool DifferenceConstraints::UpdatePotentials() {
+            vector<int64_t> dist(variableCount, numeric_limits<int64_t>::max());
+            priority_queue<pair<int64_t, int>, vector<pair<int64_t, int>>, greater<pair<int64_t, int>>> pending;
+            for(int v = 0; v < variableCount; v++) {
+                if(excess[v] > 0) {
+                    dist[v] = 0;
+                    pending.push(make_pair(0, v));
+                }
+            }
+            if(pending.empty())
+                return false;
+            int64_t maxDist = 0;
+            while(!pending.empty()) {
+                int64_t d = pending.top().first;
+                int v = pending.top().second;
+                pending.pop();
+                if(d > dist[v])
+                    continue;
+                maxDist = max(maxDist, d);
+                for(uint32_t i = arcStart[v]; i < arcStart[v + 1]; i++) {
+                    const Arc &arc = arcs[i];
+                    if(arc.capacity > 0) {
+                        int64_t nd = d + ReducedCost(v, arc);
+                        if(nd < dist[arc.to]) {
+                            dist[arc.to] = nd;
+                            pending.push(make_pair(nd, arc.to));
+                        }
+                    }
+                }
+            }
+            //Unreachable nodes are moved by the greatest distance, which keeps the reduced costs of arcs into the
+            //reachable nodes non-negative
+            for(int v = 0; v < variableCount; v++) {
+                potential[v] += min(dist[v], maxDist);
+            }
+            return true;
+        }
+
+        void DifferenceConstraints::SendFlow() {
+            vector<int> level(variableCount);
+            vector<uint32_t> current(variableCount);
+            vector<uint32_t> path;
+            while(true) {
+                //Level the graph of arcs with zero reduced cost, so that flow is only sent away from the sources and
+                //can't go round cycles
+                fill(level.begin(), level.end(), -1);
+                queue<int> pending;
+                for(int v = 0; v < variableCount; v++) {
+                    if(excess[v] > 0) {
+                        level[v] = 0;
+                        pending.push(v);
+                    }
+                }
+                bool foundSink = false;
+                while(!pending.empty()) {
+                    int v = pending.front();
+                    pending.pop();
+                    if(excess[v] < 0)
+                        foundSink = true;
+                    for(uint32_t i = arcStart[v]; i < arcStart[v + 1]; i++) {
+                        const Arc &arc = arcs[i];
+                        if((arc.capacity > 0) && (level[arc.to] == -1) && (ReducedCost(v, arc) == 0)) {
+                            level[arc.to] = level[v] + 1;
+                            pending.push(arc.to);
+                        }
+                    }
+                }
+                if(!foundSink)
+                    return;
+                for(int v = 0; v < variableCount; v++) {
+                    current[v] = arcStart[v];
+                }
+                //Find paths from each source by depth first search, giving up on nodes that lead nowhere
+                for(int source = 0; source < variableCount; source++) {
+                    while((excess[source] > 0) && (level[source] == 0)) {
+                        path.clear();
+                        int v = source;
+                        while(excess[v] >= 0 || v == source) {
+                            bool advanced = false;
+                            for(; current[v] < arcStart[v + 1]; current[v]++) {
+                                const Arc &arc = arcs[current[v]];
+                                if((arc.capacity > 0) && (level[arc.to] == level[v] + 1) && (ReducedCost(v, arc) == 0)) {
+                                    path.push_back(current[v]);
+                                    v = arc.to;
+                                    advanced = true;
+                                    break;
+                                }
+                            }
+                            if(!advanced) {
+                                level[v] = -1;
+                                if(path.empty())
+                                    break;
+                                path.pop_back();
+                                v = path.empty() ? source : arcs[path.back()].to;
+                                current[v]++;
+                            }
+                        }
+                        if(path.empty())
+                            break;
+                        int64_t amount = min(excess[source], -excess[v]);
+                        for(auto i : path) {
+                            amount = min(amount, arcs[i].capacity);
+                        }
+                        for(auto i : path) {
+                            arcs[i].capacity -= amount;
+                            arcs[arcReverse[i]].capacity += amount;
+                        }
+                        excess[source] -= amount;
+                        excess[v] += amount;
+                    }
+                }
+            }
+        }
+
+        bool DifferenceConstraints::Solve(vector<int64_t> &values) {
+            BuildGraph();
+            if(!FindFeasible())
+                return false;
+            //Variable 0 takes up the total weight of the others, as only differences between variables matter
+            excess = weights;
+            excess[0] = 0;
+            for(int v = 1; v < variableCount; v++) {
+                excess[0] -= weights[v];
+            }
+            while(UpdatePotentials()) {
+                SendFlow();
+            }
+            values.resize(variableCount);
+            for(int v = 0; v < variableCount; v++) {
+                values[v] = potential[v] - potential[0];
+            }
+            return true;
+        }
+    }
+}
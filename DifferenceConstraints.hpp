@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    /*
+    Integer linear programs made up of difference constraints x[a] - x[b] <= bound, minimising a weighted sum of the
+    variables. Retiming and latency assignment both reduce to problems of this form, with register counts as the
+    variables
+
+    The dual of the problem is a min cost flow problem, solved using the primal-dual method: shortest paths from the
+    nodes with excess flow are found using the potentials of the previous step, then as much flow as possible is sent
+    along paths of zero reduced cost. The final potentials are an optimal solution to the original problem
+
+    Variable 0 is the reference the others are measured from. Every variable is kept within a range of it, so that the
+    problem always has a finite solution if the constraints can be met
+    */
+    class DifferenceConstraints {
+    public:
+      DifferenceConstraints(int _variableCount, int64_t _range);
+      int GetVariableCount() const;
+      //Add a variable, returning its index
+      int AddVariable();
+      //Add a constraint x[a] - x[b] <= bound
+      void AddConstraint(int a, int b, int64_t bound);
+      //Add to the weight of a variable in the sum being minimised
+      void AddWeight(int var, int64_t weight);
+      //Find values of the variables minimising the weighted sum, with x[0] = 0. Returns false if the constraints can't
+      //all be met
+      bool Solve(vector<int64_t> &values);
+    private:
+      struct Constraint {
+        int a, b;
+        int64_t bound;
+      };
+      int variableCount;
+      int64_t range;
+      vector<Constraint> constraints;
+      vector<int64_t> weights;
+
+      //Residual graph of the flow problem, with the arcs leaving each node stored together
+      struct Arc {
+        int to;
+        int64_t cost, capacity;
+      };
+      vector<uint32_t> arcStart;
+      vector<Arc> arcs;
+      vector<uint32_t> arcReverse; //index of the reverse of each arc
+      vector<int64_t> potential, excess;
+      void BuildGraph();
+      //Find values meeting the constraints, which become the initial potentials. Returns false if there is a cycle of
+      //constraints with a negative total bound
+      bool FindFeasible();
+      //Update the potentials using shortest paths from the nodes with excess flow, returning false if there are none
+      bool UpdatePotentials();
+      //Send as much flow as possible from nodes with excess flow to nodes short of flow along arcs of zero reduced cost
+      void SendFlow();
+      int64_t ReducedCost(int from, const Arc &arc) const;
+    };
+  }
+}
@@ -6,8 +6,17 @@
 #include <limits>
 #include <stdexcept>
 #include <fstream>
+#include <iomanip>
+#include <tuple>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <sys/stat.h>
 #include "Util.hpp"
 #include "BasicDevices.hpp"
+#include "Optimiser.hpp"
+#include "Retimer.hpp"
+#include "NetlistReader.hpp"
 #include "Altera/CycloneIIITechnology.hpp"
 #include "Altera/AlteraDevices.hpp"
 #include "Xilinx/Artix7Technology.hpp"
@@ -16,330 +25,616 @@ using namespace std;
 namespace SynthFramework {
     namespace Polymer {
         LogicDesign::LogicDesign() {
+            ArenaScope scope(&arena);
             gnd = new Signal();
             gnd->name = "'0'";
-            ConstantDevice *gndDriver = new ConstantDevice(gnd, false);
+            gndDriver = new ConstantDevice(gnd, false);
             vcc = new Signal();
             vcc->name = "'1'";
-            ConstantDevice *vccDriver = new ConstantDevice(vcc, true);
+            vccDriver = new ConstantDevice(vcc, true);
         }
 
-        void LogicDesign::LoadDesign(string data, string prefix, const map<string, Bus*> &portmap) {
-            istringstream dss(data);
-            string line;
+        LogicDesign::~LogicDesign() {
+            arena.DestroyAll();
+            if(!sharedTechnology) {
+                delete technology;
+            }
+        }
+
+        //Statements that can appear in a netlist
+        enum NetlistStatement {
+            STMT_INPUT,
+            STMT_OUTPUT,
+            STMT_SIGNAL,
+            STMT_OPER,
+            STMT_TARGET,
+            STMT_OPTION,
+            STMT_CONSTRAINT,
+            STMT_CONSTANT,
+            STMT_ROM,
+            STMT_DEVOPT,
+            STMT_LATCON,
+            STMT_INCLUDE,
+            STMT_UNKNOWN
+        };
+
+        static const KeywordTable<NetlistStatement> statementKeywords({
+            {"INPUT", STMT_INPUT},
+            {"OUTPUT", STMT_OUTPUT},
+            {"SIGNAL", STMT_SIGNAL},
+            {"OPER", STMT_OPER},
+            {"TARGET", STMT_TARGET},
+            {"OPTION", STMT_OPTION},
+            {"CONSTRAINT", STMT_CONSTRAINT},
+            {"CONSTANT", STMT_CONSTANT},
+            {"ROM", STMT_ROM},
+            {"DEVOPT", STMT_DEVOPT},
+            {"LATCON", STMT_LATCON},
+            {"INCLUDE", STMT_INCLUDE}
+        });
+
+        //Create the technology for a named target, returning nullptr if it is not supported
+        static DeviceTechnology *CreateTechnology(const string &name) {
+            if(name == "CYCLONEIII") {
+                return new CycloneIIITechnology();
+            } else if(name == "ARTIX7") {
+                return new Artix7Technology();
+            } else {
+                return nullptr;
+            }
+        }
+
+        //Add a statement, and the prefix it was loaded with, to a hash
+        static uint64_t HashStatement(uint64_t hash, const vector<Token> &splitLine, const string &prefix) {
+            hash = HashBytes(hash, prefix.data(), prefix.size());
+            for(auto tok : splitLine) {
+                hash = HashBytes(hash, " ", 1);
+                hash = HashBytes(hash, tok.data, tok.length);
+            }
+            return HashBytes(hash, "\n", 1);
+        }
+
+        void LogicDesign::LoadDesign(const string &data, string prefix, const map<string, Bus*> &portmap) {
+            LoadDesign(data.data(), data.data() + data.size(), prefix, portmap);
+        }
+
+        bool LogicDesign::LoadDesignFile(string filename, string prefix, const map<string, Bus*> &portmap) {
+            MappedFile file;
+            if(!file.Open(filename)) {
+                return false;
+            }
+            LoadDesign(file.GetData(), file.GetData() + file.GetSize(), prefix, portmap);
+            return true;
+        }
+
+        void LogicDesign::LoadDesign(const char *begin, const char *end, string prefix, const map<string, Bus*> &portmap) {
+            ArenaScope scope(&arena);
+            if(prefix == "") {
+                //Parse all submodules up front, so that independent files can be parsed at the same time
+                vector<string> includes;
+                ParsedNetlist::FindIncludes(begin, end, includes);
+                submodules.Prefetch(includes, searchPath);
+            }
+            NetlistTokenizer tokenizer(begin, end);
+            vector<Token> splitLine;
             int lno = 1;
-            while(getline(dss, line)) {
-                if (line.find('#') != std::string::npos) {
-					line = line.substr(0, line.find('#'));
-				}
-				vector<string> splitLine;
-				istringstream iss(line);
-				std::copy(istream_iterator<string>(iss), istream_iterator<string>(), back_inserter(splitLine));
-				if (splitLine.size() == 0) continue;
-                if(splitLine[0] == "INPUT") { //Input defintiion, syntax INPUT <NAME> <TYPE> <WIDTH>
-                    Bus *inputBus = ParseSignalDefinition(splitLine, prefix);
-                    AddBus(inputBus);
-                    if(prefix == "") {
-                        DesignIO *din = new DesignIO();
-                        din->is_output = false;
-                        din->IOName = inputBus->name;
-                        din->width = inputBus->width;
-                        din->is_signed = inputBus->is_signed;
-                        din->assocBus = inputBus;
-                        io.push_back(din);
-                        int index = 0;
-                        for(auto signal : inputBus->signals) {
-                            if((inputBus->name) == "clock" && (inputBus->width == 1) && (prefix == "")) {
-                                clockSignal = signal;
-                            }
-                            DesignInputPort *dip = new DesignInputPort();
-                            dip->connectedNet = signal;
-                            signal->connectedPorts.push_back(dip);
-                            dip->design = this;
-                            dip->linkedIO = din;
-                            dip->busIndex = index;
-                            din->assocPorts.push_back(dip);
-                            inputPorts.push_back(dip);
-                            index++;
+            while(tokenizer.NextLine(splitLine)) {
+                if (splitLine.size() == 0) continue;
+                LoadStatement(splitLine, lno, prefix, portmap);
+                lno++;
+            }
+            if(prefix == "") {
+                submoduleImplementations.clear();
+                submodules.Clear();
+                if(technology == nullptr) {
+                    PrintMessage(MSG_ERROR, "no target set for design");
+                }
+            }
+        }
+
+        void LogicDesign::InstantiateSubmodule(const ParsedNetlist *module, string prefix, const map<string, Bus*> &portmap) {
+            vector<Token> splitLine;
+            for(int i = 0; i < module->GetLineCount(); i++) {
+                module->GetLine(i, splitLine);
+                LoadStatement(splitLine, i + 1, prefix, portmap);
+            }
+        }
+
+        void LogicDesign::InstantiateHierarchical(const ParsedNetlist *module, string moduleName, string prefix, const map<string, Bus*> &portmap) {
+            //Only the ports of the instance, and statements applying to the design as a whole, are loaded here. The
+            //contents of the submodule are synthesised separately
+            vector<Token> splitLine;
+            vector<Signal*> instanceInputs, instanceOutputs;
+            string signature;
+            for(int i = 0; i < module->GetLineCount(); i++) {
+                module->GetLine(i, splitLine);
+                NetlistStatement statement;
+                if(!statementKeywords.Find(splitLine[0], statement)) {
+                    statement = STMT_UNKNOWN;
+                }
+                if(statement == STMT_INPUT) {
+                    LoadStatement(splitLine, i + 1, prefix, portmap);
+                    Bus *inputBus = FindBusByName(prefix + splitLine[1]);
+                    Bus *topBus = portmap.at(splitLine[1].str());
+                    for(int j = 0; j < inputBus->width; j++) {
+                        //Extend the top level bus in the same way as the connection to it
+                        Signal *topSig;
+                        if(j < topBus->width) {
+                            topSig = topBus->signals[j];
+                        } else if(topBus->is_signed) {
+                            topSig = topBus->signals[topBus->width - 1];
+                        } else {
+                            topSig = gnd;
                         }
-                    } else {
-                        //We're in a submodule, so wire up the input to a top level signal
-                        try {
-                            Operation *wire = new Operation(OPER_CONNECT, vector<Bus*>{portmap.at(splitLine[1])}, inputBus);
-                            wire->name = prefix + "_connect_" + splitLine[1];
-                            operations.push_back(wire);
-                        } catch(out_of_range e) {
-                            PrintMessage(MSG_ERROR, "Unmapped input " + splitLine[1] + " in submodule " + prefix);
+                        topSig = topSig->Resolve();
+                        if(topSig == gnd) {
+                            signature += '0';
+                        } else if(topSig == vcc) {
+                            signature += '1';
+                        } else {
+                            signature += 'x';
                         }
                     }
+                    instanceInputs.insert(instanceInputs.end(), inputBus->signals.begin(), inputBus->signals.end());
+                } else if(statement == STMT_OUTPUT) {
+                    LoadStatement(splitLine, i + 1, prefix, portmap);
+                    Bus *outputBus = FindBusByName(prefix + splitLine[1]);
+                    instanceOutputs.insert(instanceOutputs.end(), outputBus->signals.begin(), outputBus->signals.end());
+                } else if((statement == STMT_TARGET) || (statement == STMT_OPTION)) {
+                    LoadStatement(splitLine, i + 1, prefix, portmap);
+                } else if(statement == STMT_CONSTRAINT) {
+                    //Slow signals internal to the submodule are handled when it is synthesised
+                    if((splitLine.size() >= 3) && (splitLine[1] == "SLOW") && (FindBusByName(prefix + splitLine[2]) == nullptr))
+                        continue;
+                    LoadStatement(splitLine, i + 1, prefix, portmap);
+                }
+            }
 
-                } else if(splitLine[0] == "OUTPUT") { //Output defintiion, syntax OUTPUT <NAME> <TYPE> <WIDTH>
-                    Bus *outputBus = ParseSignalDefinition(splitLine, prefix);
-                    if(prefix == "") {
-                        //Add prefix to enable output buffers
-                        string origName = outputBus->name;
-                        outputBus->name = origName + "_int";
-                        AddBus(outputBus);
-                        outputBus->name = origName;
-                        DesignIO *dout = new DesignIO();
-                        dout->is_output = true;
-                        dout->IOName = origName;
-                        dout->width = outputBus->width;
-                        dout->is_signed = outputBus->is_signed;
-                        dout->assocBus = outputBus;
-                        io.push_back(dout);
-                        int index = 0;
-                        for(auto signal : outputBus->signals) {
-                            DesignOutputPort *dop = new DesignOutputPort();
-                            dop->connectedNet = signal;
-                            signal->connectedPorts.push_back(dop);
-                            dop->design = this;
-                            dop->linkedIO = dout;
-                            dop->busIndex = index;
-                            dout->assocPorts.push_back(dop);
-                            outputPorts.push_back(dop);
-                            index++;
-                        }
-                    } else {
-                        AddBus(outputBus);
-                        //We're in a submodule, so wire up the output to a top level signal
-                        try {
-                            Operation *wire = new Operation(OPER_CONNECT, vector<Bus*>{outputBus}, portmap.at(splitLine[1]));
-                            wire->name = prefix + "_connect_" + splitLine[1];
-                            operations.push_back(wire);
-                        } catch(out_of_range e) {
-                            PrintMessage(MSG_ERROR, "Unmapped output " + splitLine[1] + " in submodule " + prefix);
-                        }
+            SubmoduleImplementation *impl = GetSubmoduleImplementation(module, moduleName, signature);
+            LogicDesign *sub = impl->design.get();
+            //The copied devices depend on everything the submodule's synthesis did
+            contentHash = HashBytes(contentHash, &sub->contentHash, sizeof(sub->contentHash));
+
+            //Map nets of the implementation to nets of this design, creating them as they are first used
+            unordered_map<Signal*, Signal*> netMap;
+            netMap[sub->gnd] = gnd;
+            netMap[sub->vcc] = vcc;
+            if(clockSignal != nullptr) {
+                netMap[impl->implicitClock] = clockSignal;
+            }
+            for(int i = 0; i < impl->inputs.size(); i++) {
+                if(impl->inputs[i] != nullptr) {
+                    netMap[impl->inputs[i]->connectedNet] = instanceInputs[i];
+                }
+            }
+            for(int i = 0; i < impl->outputs.size(); i++) {
+                Signal *net = impl->outputs[i]->connectedNet;
+                auto mapped = netMap.find(net);
+                if(mapped != netMap.end()) {
+                    //Outputs connected directly to an input, a constant or another output
+                    instanceOutputs[i]->ConnectTo(mapped->second);
+                } else {
+                    netMap[net] = instanceOutputs[i];
+                }
+            }
+            auto MapNet = [&](Signal *net) -> Signal* {
+                auto mapped = netMap.find(net);
+                if(mapped != netMap.end()) {
+                    return mapped->second->Resolve();
+                }
+                Signal *sig = CreateSignal(prefix + net->name);
+                sig->isSlow = net->isSlow;
+                sig->avoidPipeline = net->avoidPipeline;
+                netMap[net] = sig;
+                return sig;
+            };
+
+            for(auto dev : sub->devices) {
+                LogicDevice *copy = dev->Clone();
+                if(copy == nullptr) {
+                    PrintMessage(MSG_ERROR, "device " + dev->name + " in submodule " + moduleName + " cannot be copied");
+                }
+                copy->name = prefix + dev->name;
+                for(auto inp : dev->inputPorts) {
+                    DeviceInputPort *port = new DeviceInputPort();
+                    port->device = copy;
+                    port->pin = inp->pin;
+                    port->Connect(MapNet(inp->connectedNet));
+                    copy->inputPorts.push_back(port);
+                }
+                for(auto outp : dev->outputPorts) {
+                    DeviceOutputPort *port = new DeviceOutputPort();
+                    port->device = copy;
+                    port->pin = outp->pin;
+                    port->Connect(MapNet(outp->connectedNet));
+                    copy->outputPorts.push_back(port);
+                }
+                AddDevice(copy);
+            }
+        }
 
-                    }
+        LogicDesign::SubmoduleImplementation *LogicDesign::GetSubmoduleImplementation(const ParsedNetlist *module, string moduleName, const string &signature) {
+            auto key = make_pair(module, signature);
+            auto existing = submoduleImplementations.find(key);
+            if(existing != submoduleImplementations.end()) {
+                return existing->second.get();
+            }
+            PrintMessage(MSG_NOTE, "synthesising submodule " + moduleName + " with constant inputs " + signature);
+            SubmoduleImplementation *impl = new SubmoduleImplementation();
+            submoduleImplementations[key].reset(impl);
+            LogicDesign *sub = new LogicDesign();
+            impl->design.reset(sub);
+            sub->designName = moduleName;
+            sub->technology = technology;
+            sub->sharedTechnology = (technology != nullptr);
+            sub->searchPath = searchPath;
+            sub->hierarchical = true;
+            sub->cacheDirectory = cacheDirectory;
+            sub->technologyHash = technologyHash;
+            sub->contentHash = HashBytes(technologyHash, signature.data(), signature.size());
+            {
+                ArenaScope scope(&sub->arena);
+                //Replaced by the clock input of the submodule if it has one
+                impl->implicitClock = sub->CreateSignal("clock");
+                sub->clockSignal = impl->implicitClock;
+                sub->submodules.Prefetch(module->includes, searchPath);
+                sub->InstantiateSubmodule(module, "", map<string, Bus*>());
+                sub->submoduleImplementations.clear();
+                sub->submodules.Clear();
+            }
+            if(sub->technology == nullptr) {
+                PrintMessage(MSG_ERROR, "target must be set before submodule " + moduleName + " is included");
+            }
+            //Tie inputs that are constant in this instance, so that they are optimised away
+            for(int i = 0; i < sub->inputPorts.size(); i++) {
+                if(signature[i] != 'x') {
+                    DesignInputPort *dip = sub->inputPorts[i];
+                    Signal *net = dip->connectedNet;
+                    dip->Disconnect();
+                    net->ConnectTo((signature[i] == '1') ? sub->vcc : sub->gnd);
+                }
+            }
+            sub->SynthesiseAndOptimiseDesign();
+            //Ports are only found afterwards, as they are replaced if the netlist is loaded from the cache
+            for(int i = 0; i < sub->inputPorts.size(); i++) {
+                impl->inputs.push_back((signature[i] == 'x') ? sub->inputPorts[i] : nullptr);
+            }
+            impl->outputs = sub->outputPorts;
+            return impl;
+        }
 
-                } else if(splitLine[0] == "SIGNAL") { //Internal signal definition, syntax SIGNAL <NAME> <TYPE> <WIDTH>
-                    Bus *sigBus = ParseSignalDefinition(splitLine, prefix);
-                    AddBus(sigBus);
-                } else if(splitLine[0] == "OPER") { //Some kind of operation
-                    if(splitLine.size() < 4) {
-                        PrintMessage(MSG_ERROR, "Invalid operation definition");
-                    }
-                    OperationType type;
-                    if(!GetOperationByName(splitLine[1], type)) {
-                        PrintMessage(MSG_ERROR, "Invalid operation type");
+        void LogicDesign::LoadStatement(const vector<Token> &splitLine, int lno, const string &prefix, const map<string, Bus*> &portmap) {
+            contentHash = HashStatement(contentHash, splitLine, prefix);
+            NetlistStatement statement;
+            if(!statementKeywords.Find(splitLine[0], statement)) {
+                statement = STMT_UNKNOWN;
+            }
+            if(statement == STMT_INPUT) { //Input defintiion, syntax INPUT <NAME> <TYPE> <WIDTH>
+                Bus *inputBus = ParseSignalDefinition(splitLine, prefix);
+                AddBus(inputBus);
+                if(prefix == "") {
+                    DesignIO *din = new DesignIO();
+                    din->is_output = false;
+                    din->IOName = inputBus->name;
+                    din->width = inputBus->width;
+                    din->is_signed = inputBus->is_signed;
+                    din->assocBus = inputBus;
+                    io.push_back(din);
+                    int index = 0;
+                    for(auto signal : inputBus->signals) {
+                        if((inputBus->name) == "clock" && (inputBus->width == 1) && (prefix == "")) {
+                            clockSignal = signal;
+                        }
+                        DesignInputPort *dip = new DesignInputPort();
+                        dip->Connect(signal);
+                        dip->design = this;
+                        dip->linkedIO = din;
+                        dip->busIndex = index;
+                        din->assocPorts.push_back(dip);
+                        inputPorts.push_back(dip);
+                        index++;
                     }
-                    int nOperands = OperationInfo[type].nOperands;
-                    vector<Bus*> operands;
-                    if(splitLine.size() < (nOperands+3)) {
-                        PrintMessage(MSG_ERROR, "Insufficient operand count");
+                } else {
+                    //We're in a submodule, so wire up the input to a top level signal
+                    try {
+                        Operation *wire = new Operation(OPER_CONNECT, vector<Bus*>{portmap.at(splitLine[1].str())}, inputBus);
+                        wire->name = prefix + "_connect_" + splitLine[1];
+                        operations.push_back(wire);
+                    } catch(out_of_range e) {
+                        PrintMessage(MSG_ERROR, "Unmapped input " + splitLine[1] + " in submodule " + prefix);
                     }
-                    for(int i = 0; i < nOperands; i++) {
-                        Bus* oper = FindBusByName(prefix + splitLine[i+2]);
-                        if(oper == nullptr) {
-                            PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[i+2] + "'");
-                        }
-                        operands.push_back(oper);
+                }
+
+            } else if(statement == STMT_OUTPUT) { //Output defintiion, syntax OUTPUT <NAME> <TYPE> <WIDTH>
+                Bus *outputBus = ParseSignalDefinition(splitLine, prefix);
+                if(prefix == "") {
+                    //Add prefix to enable output buffers
+                    string origName = outputBus->name;
+                    AddBus(outputBus, origName + "_int");
+                    DesignIO *dout = new DesignIO();
+                    dout->is_output = true;
+                    dout->IOName = origName;
+                    dout->width = outputBus->width;
+                    dout->is_signed = outputBus->is_signed;
+                    dout->assocBus = outputBus;
+                    io.push_back(dout);
+                    int index = 0;
+                    for(auto signal : outputBus->signals) {
+                        DesignOutputPort *dop = new DesignOutputPort();
+                        dop->Connect(signal);
+                        dop->design = this;
+                        dop->linkedIO = dout;
+                        dop->busIndex = index;
+                        dout->assocPorts.push_back(dop);
+                        outputPorts.push_back(dop);
+                        index++;
                     }
-                    Bus *output = FindBusByName(prefix + splitLine[nOperands+2]);
-                    if(output == nullptr) {
-                        PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[nOperands+2] + "'");
+                } else {
+                    AddBus(outputBus);
+                    //We're in a submodule, so wire up the output to a top level signal
+                    try {
+                        Operation *wire = new Operation(OPER_CONNECT, vector<Bus*>{outputBus}, portmap.at(splitLine[1].str()));
+                        wire->name = prefix + "_connect_" + splitLine[1];
+                        operations.push_back(wire);
+                    } catch(out_of_range e) {
+                        PrintMessage(MSG_ERROR, "Unmapped output " + splitLine[1] + " in submodule " + prefix);
                     }
-                    Operation *operation = new Operation(type, operands, output);
-                    operation->name = prefix + "oper" + to_string(lno);
-                    operations.push_back(operation);
-                } else if(splitLine[0] == "TARGET") {
-                    if(splitLine.size() < 2) {
-                        PrintMessage(MSG_ERROR, "Named target required");
+
+                }
+
+            } else if(statement == STMT_SIGNAL) { //Internal signal definition, syntax SIGNAL <NAME> <TYPE> <WIDTH>
+                Bus *sigBus = ParseSignalDefinition(splitLine, prefix);
+                AddBus(sigBus);
+            } else if(statement == STMT_OPER) { //Some kind of operation
+                if(splitLine.size() < 4) {
+                    PrintMessage(MSG_ERROR, "Invalid operation definition");
+                }
+                OperationType type;
+                if(!GetOperationByName(splitLine[1], type)) {
+                    PrintMessage(MSG_ERROR, "Invalid operation type");
+                }
+                int nOperands = OperationInfo[type].nOperands;
+                vector<Bus*> operands;
+                if(splitLine.size() < (nOperands+3)) {
+                    PrintMessage(MSG_ERROR, "Insufficient operand count");
+                }
+                for(int i = 0; i < nOperands; i++) {
+                    Bus* oper = FindBusByName(prefix + splitLine[i+2]);
+                    if(oper == nullptr) {
+                        PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[i+2] + "'");
                     }
+                    operands.push_back(oper);
+                }
+                Bus *output = FindBusByName(prefix + splitLine[nOperands+2]);
+                if(output == nullptr) {
+                    PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[nOperands+2] + "'");
+                }
+                Operation *operation = new Operation(type, operands, output);
+                operation->name = prefix + "oper" + to_string(lno);
+                operations.push_back(operation);
+            } else if(statement == STMT_TARGET) {
+                if(splitLine.size() < 2) {
+                    PrintMessage(MSG_ERROR, "Named target required");
+                }
+                technologyHash = HashStatement(technologyHash, splitLine, "");
 
-                    if(splitLine[1] == "CYCLONEIII") {
-                        technology = new CycloneIIITechnology();
-                    } else if(splitLine[1] == "ARTIX7") {
-                        technology = new Artix7Technology();
-                    } else {
+                if(!sharedTechnology) {
+                    //A submodule synthesised on its own uses the technology of the design including it instead
+                    targetName = splitLine[1].str();
+                    technology = CreateTechnology(targetName);
+                    if(technology == nullptr) {
                         PrintMessage(MSG_ERROR, "Target " + splitLine[1] + " not supported");
                     }
-                } else if(splitLine[0] == "OPTION") {
-                    if(splitLine.size() < 3) {
-                        PrintMessage(MSG_ERROR, "Option and value required");
-                    }
-
-                    if(splitLine[1] == "PIPELINE") {
-                        allowPipeline = (splitLine[2] == "ON");
-                    }
-                } else if(splitLine[0] == "CONSTRAINT") {
-                    bool is_int = false;
-                    bool is_other = false;
-                    int *iDest;
-                    double *dDest;
-                    if(splitLine[1] == "FREQUENCY") {
-                        is_int = false;
-                        dDest = &targetFrequency;
-                    } else if(splitLine[1] == "BUDGET") {
-                        is_int = false;
-                        dDest = &timingBudget;
-                    } else if(splitLine[1] == "SLACK") {
-                        is_int = false;
-                        dDest = &timingSlack;
-                    } else if(splitLine[1] == "MAXLATENCY") {
-                        is_int = true;
-                        iDest = &maxLatency;
-                    } else if(splitLine[1] == "MINLATENCY") {
-                        is_int = true;
-                        iDest = &minLatency;
-                    } else if(splitLine[1] == "SLOW") {
-                        is_other = true;
-                        Bus *bus = FindBusByName(prefix + splitLine[2]);
-                        for(auto sig : bus->signals) {
-                          sig->isSlow = true;
-                        }
-                    } else {
-                        PrintMessage(MSG_ERROR, "unknown constraint " + splitLine[1]);
-                    }
-                    if(!is_other) {
-                      if(is_int) {
-                          *iDest = stoi(splitLine[2]);
-                      } else {
-                          *dDest = stod(splitLine[2]);
-                      }
-                    }
-
-                } else if(splitLine[0] == "CONSTANT") {
-                    Bus *cnstBus = ParseSignalDefinition(splitLine, prefix);
-                    AddBus(cnstBus);
-                    if(splitLine.size() < 5) {
-                        PrintMessage(MSG_ERROR, "constant must have value");
-                    }
-                    string cv = splitLine[4];
-                    int bit = 0;
-                    for(int i = cv.size() - 1; i >= 0; i--) {
-                        if(bit >= cnstBus->width) break;
-                        if(cv[i] == '1') {
-                            cnstBus->signals[bit]->ConnectTo(vcc);
-                        } else if(cv[i] == '0') {
-                            cnstBus->signals[bit]->ConnectTo(gnd);
-                        } else {
-                            PrintMessage(MSG_ERROR, "unexpected character in binary constant");
-                        }
-                        bit++;
-                    }
-                } else if(splitLine[0] == "ROM") {
-                    if(splitLine.size() < 6) {
-                        PrintMessage(MSG_ERROR, "invalid rom statement");
-                    }
-                    int width = stoi(splitLine[1]);
-                    int length = stoi(splitLine[2]);
-                    string mifname = splitLine[3];
-                    Bus *addressBus = FindBusByName(prefix + splitLine[4]);
-                    if(addressBus == nullptr) {
-                        PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[4] + "'");
-                    }
-                    Bus *dataBus = FindBusByName(prefix + splitLine[5]);
-                    if(dataBus == nullptr) {
-                        PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[5] + "'");
-                    }
-                    devices.push_back(new Altera_ROM(width, length, mifname, clockSignal, addressBus->signals, dataBus->signals));
-                } else if(splitLine[0] == "DEVOPT") {
-                    if(technology != nullptr) {
-                      technology->SetDeviceConstraint(splitLine);
-                    } else{
-                      PrintMessage(MSG_ERROR, "technology must be set up before a DEVOPT statement");
-                    }
-                } else if(splitLine[0] == "LATCON") {
-                  //latency constraint:
-                  //LATCON output input ext_latency
-                  LatencyConstraint *latcon = new LatencyConstraint();
-                  Bus *outbus = FindBusByName(prefix + splitLine[1]);
-                  Bus *inbus = FindBusByName(prefix + splitLine[2]);
-                  latcon->ext_latency = stoi(splitLine[3]);
-
-                  for(auto outsig : outbus->signals) {
-                    DesignOutputPort *dop = nullptr;
-                    for(auto port : outsig->connectedPorts) {
-                      if(dynamic_cast<DesignOutputPort*>(port) != nullptr) {
-                        dop = dynamic_cast<DesignOutputPort*>(port);
-                        break;
-                      }
-                    }
-                    if(dop != nullptr) {
-                      dop->latcons.push_back(latcon);
-                      latcon->outputs.push_back(dop);
-                    }
+                }
+            } else if(statement == STMT_OPTION) {
+                if(splitLine.size() < 3) {
+                    PrintMessage(MSG_ERROR, "Option and value required");
+                }
 
+                if(splitLine[1] == "PIPELINE") {
+                    allowPipeline = (splitLine[2] == "ON") || (splitLine[2] == "MINREG");
+                    minimiseRegisters = (splitLine[2] == "MINREG");
+                } else if(splitLine[1] == "RETIME") {
+                    allowRetime = (splitLine[2] == "ON");
+                } else if(splitLine[1] == "SHIFTREG") {
+                    allowShiftRegisters = (splitLine[2] == "ON");
+                } else if(splitLine[1] == "HIERARCHY") {
+                    hierarchical = (splitLine[2] == "ON");
+                }
+            } else if(statement == STMT_CONSTRAINT) {
+                bool is_int = false;
+                bool is_other = false;
+                int *iDest;
+                double *dDest;
+                if(splitLine[1] == "FREQUENCY") {
+                    is_int = false;
+                    dDest = &targetFrequency;
+                } else if(splitLine[1] == "BUDGET") {
+                    is_int = false;
+                    dDest = &timingBudget;
+                } else if(splitLine[1] == "SLACK") {
+                    is_int = false;
+                    dDest = &timingSlack;
+                } else if(splitLine[1] == "MAXLATENCY") {
+                    is_int = true;
+                    iDest = &maxLatency;
+                } else if(splitLine[1] == "MINLATENCY") {
+                    is_int = true;
+                    iDest = &minLatency;
+                } else if(splitLine[1] == "SLOW") {
+                    is_other = true;
+                    Bus *bus = FindBusByName(prefix + splitLine[2]);
+                    for(auto sig : bus->signals) {
+                      sig->isSlow = true;
+                    }
+                } else {
+                    PrintMessage(MSG_ERROR, "unknown constraint " + splitLine[1]);
+                }
+                if(!is_other) {
+                  if(is_int) {
+                      *iDest = stoi(splitLine[2].str());
+                  } else {
+                      *dDest = stod(splitLine[2].str());
                   }
+                }
 
-                  for(auto insig : inbus->signals) {
-                    DesignInputPort *dip = nullptr;
-                    for(auto port : insig->connectedPorts) {
-                      if(dynamic_cast<DesignInputPort*>(port) != nullptr) {
-                        dip = dynamic_cast<DesignInputPort*>(port);
-                        break;
-                      }
-                    }
-                    if(dip != nullptr) {
-                      dip->latcon = latcon;
-                      latcon->inputs.push_back(dip);
+            } else if(statement == STMT_CONSTANT) {
+                Bus *cnstBus = ParseSignalDefinition(splitLine, prefix);
+                AddBus(cnstBus);
+                if(splitLine.size() < 5) {
+                    PrintMessage(MSG_ERROR, "constant must have value");
+                }
+                string cv = splitLine[4].str();
+                int bit = 0;
+                for(int i = cv.size() - 1; i >= 0; i--) {
+                    if(bit >= cnstBus->width) break;
+                    if(cv[i] == '1') {
+                        cnstBus->signals[bit]->ConnectTo(vcc);
+                    } else if(cv[i] == '0') {
+                        cnstBus->signals[bit]->ConnectTo(gnd);
+                    } else {
+                        PrintMessage(MSG_ERROR, "unexpected character in binary constant");
                     }
+                    bit++;
+                }
+            } else if(statement == STMT_ROM) {
+                if(splitLine.size() < 6) {
+                    PrintMessage(MSG_ERROR, "invalid rom statement");
+                }
+                int width = stoi(splitLine[1].str());
+                int length = stoi(splitLine[2].str());
+                string mifname = splitLine[3].str();
+                Bus *addressBus = FindBusByName(prefix + splitLine[4]);
+                if(addressBus == nullptr) {
+                    PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[4] + "'");
+                }
+                Bus *dataBus = FindBusByName(prefix + splitLine[5]);
+                if(dataBus == nullptr) {
+                    PrintMessage(MSG_ERROR, "Can't find '" + prefix + splitLine[5] + "'");
+                }
+                AddDevice(new Altera_ROM(width, length, mifname, clockSignal, addressBus->signals, dataBus->signals));
+            } else if(statement == STMT_DEVOPT) {
+                technologyHash = HashStatement(technologyHash, splitLine, "");
+                if(technology != nullptr) {
+                  vector<string> options;
+                  for(auto tok : splitLine) {
+                      options.push_back(tok.str());
                   }
-                  latcons.push_back(latcon);
-                } else if(splitLine[0] == "INCLUDE") {
-                  //Include a submodule
-                  //Syntax:
-                  //INCLUDE submodule_name instance_name SUBMODULE_IO1=>DESIGN_BUS1 SUBMODULE_IO2=>DESIGN_BUS2 ...
-                  ifstream infs;
-                  vector<string> allowedExtensions{".polynet.enc", ".ecc.polynet.enc", ".polynet", ".ecc.polynet"};
-                  bool found = false;
-                  for(auto dir : searchPath) {
-                      for(auto ext : allowedExtensions) {
-                          infs.open(dir + "/" + splitLine[1] + ext);
-                          if(infs.is_open()) {
-                              found = true;
-                              break;
-                          }
-                      }
-                      if(found)
-                        break;
+                  ApplyDeviceOption(options);
+                  deviceOptions.push_back(options);
+                } else{
+                  PrintMessage(MSG_ERROR, "technology must be set up before a DEVOPT statement");
+                }
+            } else if(statement == STMT_LATCON) {
+              //latency constraint:
+              //LATCON output input ext_latency
+              LatencyConstraint *latcon = new LatencyConstraint();
+              Bus *outbus = FindBusByName(prefix + splitLine[1]);
+              Bus *inbus = FindBusByName(prefix + splitLine[2]);
+              latcon->ext_latency = stoi(splitLine[3].str());
+
+              for(auto outsig : outbus->signals) {
+                DesignOutputPort *dop = nullptr;
+                for(auto port : outsig->fanout) {
+                  if(dynamic_cast<DesignOutputPort*>(port) != nullptr) {
+                    dop = dynamic_cast<DesignOutputPort*>(port);
+                    break;
                   }
-                  if(!found) {
-                      PrintMessage(MSG_ERROR, "failed to find submodule " + splitLine[1] + " in any current directories");
+                }
+                if(dop != nullptr) {
+                  dop->latcons.push_back(latcon);
+                  latcon->outputs.push_back(dop);
+                }
+
+              }
+
+              for(auto insig : inbus->signals) {
+                DesignInputPort *dip = dynamic_cast<DesignInputPort*>(insig->driver);
+                for(auto port : insig->extraDrivers) {
+                  if(dip == nullptr) {
+                    dip = dynamic_cast<DesignInputPort*>(port);
                   }
-                  string inst_name = splitLine[2];
-                  map<string, Bus*> portmap;
-                  for(int i = 3; i < splitLine.size(); i++) {
-                      string assoc = splitLine[i];
-                      int delimPos = assoc.find("=>");
-                      if(delimPos == string::npos) {
-                          PrintMessage(MSG_ERROR, "invalid port mapping definition");
-                      }
-                      string modulePort = assoc.substr(0, delimPos);
-                      string topBusName = assoc.substr(delimPos+2);
-                      Bus * topBus = FindBusByName(prefix + topBusName);
-                      if(topBus == nullptr) {
-                          PrintMessage(MSG_ERROR, "bus " + topBusName + " in port map not found");
-                      }
-                      portmap[modulePort] = topBus;
-                   }
-                   string moduleCode = string((istreambuf_iterator<char>(infs)), istreambuf_iterator<char>());
-                   LoadDesign(moduleCode, prefix + inst_name + "__" , portmap);
-                } else {
-                    PrintMessage(MSG_ERROR, "syntax error in netlist");
                 }
-                lno++;
+                if(dip != nullptr) {
+                  dip->latcon = latcon;
+                  latcon->inputs.push_back(dip);
+                }
+              }
+              latcons.push_back(latcon);
+            } else if(statement == STMT_INCLUDE) {
+              //Include a submodule
+              //Syntax:
+              //INCLUDE submodule_name instance_name SUBMODULE_IO1=>DESIGN_BUS1 SUBMODULE_IO2=>DESIGN_BUS2 ...
+              //Each submodule is only found and parsed once, however many times it is included
+              const ParsedNetlist *module = submodules.Get(splitLine[1].str(), searchPath);
+              if(module == nullptr) {
+                  PrintMessage(MSG_ERROR, "failed to find submodule " + splitLine[1] + " in any current directories");
+              }
+              string inst_name = splitLine[2].str();
+              map<string, Bus*> portmap;
+              for(int i = 3; i < splitLine.size(); i++) {
+                  string assoc = splitLine[i].str();
+                  int delimPos = assoc.find("=>");
+                  if(delimPos == string::npos) {
+                      PrintMessage(MSG_ERROR, "invalid port mapping definition");
+                  }
+                  string modulePort = assoc.substr(0, delimPos);
+                  string topBusName = assoc.substr(delimPos+2);
+                  Bus * topBus = FindBusByName(prefix + topBusName);
+                  if(topBus == nullptr) {
+                      PrintMessage(MSG_ERROR, "bus " + topBusName + " in port map not found");
+                  }
+                  portmap[modulePort] = topBus;
+               }
+               if(hierarchical) {
+                   InstantiateHierarchical(module, splitLine[1].str(), prefix + inst_name + "__", portmap);
+               } else {
+                   InstantiateSubmodule(module, prefix + inst_name + "__" , portmap);
+               }
+            } else {
+                PrintMessage(MSG_ERROR, "syntax error in netlist");
             }
-        };
+        }
 
 
         void LogicDesign::SynthesiseAndOptimiseDesign() {
+            ArenaScope scope(&arena);
+            string cacheFile = "";
+            if(cacheDirectory != "") {
+                cacheFile = GetCacheFilename();
+                if(LoadFromCache(cacheFile)) {
+                    return;
+                }
+            }
+            mergeDuplicateDevices = true;
             for(auto oper : operations) {
+                //Operands may be slices referring to signals merged by earlier operations
+                for(auto input : oper->inputs) {
+                    input->ResolveSignals();
+                }
+                oper->output->ResolveSignals();
                 oper->Synthesise(this);
+                //Signals created by the operation can't be changed until it is complete
+                MergePendingDuplicates();
+            }
+            mergeDuplicateDevices = false;
+            if(!mergedDevices.empty()) {
+                PrintMessage(MSG_NOTE, to_string(mergedDevices.size()) + " duplicate devices were merged during synthesis");
+                devices.erase(remove_if(devices.begin(), devices.end(), [this](LogicDevice *dev) {
+                    return mergedDevices.find(dev) != mergedDevices.end();
+                }), devices.end());
+                for(auto dev : mergedDevices) {
+                    DestroyDevice(dev);
+                }
+                mergedDevices.clear();
             }
+            //Keys may have been invalidated by signals being connected together, the optimiser rebuilds the table
+            structuralHash.Clear();
             PrintMessage(MSG_NOTE, "basic synthesis produced " + to_string(devices.size()) + " devices before optimisation");
 
             //Run connectivity check before optimisation
             for(auto sig : signals) {
-                int numDrivers = 0, numDriven = 0;
-                for(auto port : sig->connectedPorts) {
-                    if(port->IsDriver())
-                       numDrivers++;
-                    else
-                       numDriven++;
-                }
+                int numDrivers = sig->GetDriverCount(), numDriven = sig->GetFanout();
                 if((numDrivers == 0)  && (numDriven > 0)) {
                     PrintMessage(MSG_WARNING, "net ===" + sig->name + "=== has non-zero fanout and no driver");
                 } else if(numDrivers > 1) {
@@ -348,324 +643,918 @@ namespace SynthFramework {
             }
 
             //Keep optimising until no more optimisations are possible
-            bool didOptimise = false;
-            do {
-                didOptimise = false;
-            //    PrintMessage(MSG_NOTE, "optimising");
-
-                //Run device specific optimisations
-                for(auto device : devices) {
-                    if(device->OptimiseDevice(this)) {
-                        didOptimise = true;
-                    }
-                }
-                vector<LogicDevice*> devicesToPurge;
-                //Optimise away devices with no fanout
-                for(int i = 0; i < devices.size(); i++) {
-                    bool hasFanout = false;
-                    for(auto outPin : devices[i]->outputPorts) {
-                        if(outPin->connectedNet->GetFanout() > 0) {
-                            hasFanout = true;
-                        }
+            Optimiser optimiser(this);
+            optimiser.Run();
+
+            int lutTotal = 0, ffTotal = 0;
+            for(auto dev : devices) {
+                if(dev->kind == DEVICE_LUT) {
+                    lutTotal++;
+                } else if(dev->kind == DEVICE_FLIPFLOP) {
+                    ffTotal++;
+                }
+            }
+            PrintMessage(MSG_NOTE, "optimised design contains " + to_string(lutTotal) + " LUT and " + to_string(ffTotal) + " FF");
+            if(cacheFile != "") {
+                StoreInCache(cacheFile);
+            }
+        }
+
+        void LogicDesign::AnalyseTiming() {
+            NetlistIndex index(this);
+            vector<CellId> order;
+            vector<uint32_t> levelStart;
+            index.Levelize(order, levelStart);
+            AnalyseTimingLevelized(index, order, levelStart);
+            index.StoreTiming();
+        }
+
+        void LogicDesign::AnalyseTimingLevelized(NetlistIndex &index, const vector<CellId> &order, const vector<uint32_t> &levelStart) {
+            int threadCount = (timingThreads > 0) ? timingThreads : max<int>(thread::hardware_concurrency(), 1);
+            //Starting threads costs more than evaluating small levels, such as those along a carry chain
+            const uint32_t minParallelLevel = 4096;
+            vector<CellId> serialCells;
+            for(int level = 0; (level + 1) < levelStart.size(); level++) {
+                uint32_t begin = levelStart[level], end = levelStart[level + 1];
+                if((threadCount < 2) || ((end - begin) < minParallelLevel)) {
+                    for(uint32_t i = begin; i < end; i++) {
+                        EvaluateCellTiming(index, order[i]);
+                    }
+                    continue;
+                }
+                //Cells in a level don't depend on each other, so LUTs and flip flops can be evaluated concurrently.
+                //Vendor specific devices are analysed through the Signal objects, as are nets with more than one
+                //driver, so these are left until afterwards. Building the index looked up the net of every port, so
+                //no port is left referring to a merged net for the threads to update
+                serialCells.clear();
+                for(uint32_t i = begin; i < end; i++) {
+                    CellId cell = order[i];
+                    CellKind kind = index.GetCellKind(cell);
+                    if(((kind != CELL_LUT) && (kind != CELL_FLIPFLOP)) || (index.GetDriver(index.GetOutputs(cell)[0]) != cell)) {
+                        serialCells.push_back(cell);
                     }
-                    if(!hasFanout) {
-                        didOptimise = true;
-                        PrintMessage(MSG_DEBUG, "device ===" + devices[i]->name + "=== has no fanout and will be removed");
-                        devicesToPurge.push_back(devices[i]);
-                    }
-                }
-
-                //Optimise away duplicate devices
-                for(auto sig : signals) {
-                    //Look for devices with a common input pin to reduce the cost of the search
-                    for(auto a : sig->connectedPorts) {
-                        for(auto b : sig->connectedPorts) {
-                            if(a != b) {
-                                DeviceInputPort *dia = dynamic_cast<DeviceInputPort*>(a), *dib = dynamic_cast<DeviceInputPort*>(b);
-                                if((dia != nullptr) && (dib != nullptr)) {
-                                   if(dia->device != dib->device) {
-                                       if(dia->device->IsEquivalentTo(dib->device)) {
-                                           if((find(devicesToPurge.begin(), devicesToPurge.end(), dia->device) == devicesToPurge.end())
-                                                && (find(devicesToPurge.begin(), devicesToPurge.end(), dib->device) == devicesToPurge.end())) {
-                                                    didOptimise = true;
-                                                    for(int i = 0; i < dia->device->outputPorts.size(); i++) {
-                                                        Signal *oldNet = dib->device->outputPorts[i]->connectedNet;
-                                                        PrintMessage(MSG_DEBUG, "nets ===" + oldNet->name + "=== and ===" + dia->device->outputPorts[i]->connectedNet->name + "=== are driven by identical devices and will be merged");
-                                                        dib->device->outputPorts[i]->Disconnect();
-                                                        oldNet->ConnectTo(dia->device->outputPorts[i]->connectedNet);
-                                                    }
-                                                    devicesToPurge.push_back(dib->device);
-                                                }
-
-                                       }
-                                   }
-                                }
-                             }
+                }
+                uint32_t chunk = ((end - begin) + threadCount - 1) / threadCount;
+                vector<thread> threads;
+                for(uint32_t first = begin; first < end; first += chunk) {
+                    uint32_t last = min(first + chunk, end);
+                    threads.push_back(thread([&index, &order, first, last, this]() {
+                        for(uint32_t i = first; i < last; i++) {
+                            CellId cell = order[i];
+                            CellKind kind = index.GetCellKind(cell);
+                            if(((kind == CELL_LUT) || (kind == CELL_FLIPFLOP)) && (index.GetDriver(index.GetOutputs(cell)[0]) == cell)) {
+                                EvaluateCellTiming(index, cell);
+                            }
                         }
+                    }));
+                }
+                for(auto &t : threads) {
+                    t.join();
+                }
+                for(auto cell : serialCells) {
+                    EvaluateCellTiming(index, cell);
+                }
+            }
+        }
+
+        void LogicDesign::EvaluateCellTiming(NetlistIndex &index, CellId cell) {
+            IdRange<NetId> inputs = index.GetInputs(cell), outputs = index.GetOutputs(cell);
+            switch(index.GetCellKind(cell)) {
+            case CELL_LUT:
+                //Consider routing delays, different depending on input origin, and the delay through each input
+                for(int c = 0; c < index.GetCornerCount(); c++) {
+                    const vector<double> &netDelay = index.netDelay[c], &netRoutingDelay = index.netRoutingDelay[c];
+                    IdRange<double> pinDelays = index.GetLUTPinDelays(cell, c);
+                    double worst_tpd = 0;
+                    for(int i = 0; i < inputs.size(); i++) {
+                        worst_tpd = max(worst_tpd, netDelay[inputs[i]] + netRoutingDelay[inputs[i]] + pinDelays[i]);
                     }
+                    index.netDelay[c][outputs[0]] = worst_tpd;
+                }
+                break;
+            case CELL_FLIPFLOP:
+                for(int c = 0; c < index.GetCornerCount(); c++) {
+                    index.netDelay[c][outputs[0]] = index.cellDelay[c][cell];
                 }
+                break;
+            case CELL_VENDOR:
+                //Vendor specific timing works on the Signal objects, so pass timing information through those
+                for(auto input : inputs) {
+                    index.StoreNetTiming(input);
+                }
+                technology->AnalyseTiming(static_cast<VendorSpecificDevice*>(index.GetCell(cell)), this);
+                for(auto output : outputs) {
+                    index.LoadNetTiming(output);
+                }
+                break;
+            default:
+                break;
+            }
+        }
 
-                for(auto dtp : devicesToPurge) {
-                    int indexInArray = -1;
-                    for(int i = 0; i < devices.size(); i++) {
-                        if(devices[i] == dtp) {
-                            indexInArray = i;
+        void LogicDesign::AnalyseConeTiming(NetlistIndex &index, CellId target) {
+            //Depth first traversal of the out of date cells driving the target, evaluating each cell after all the
+            //cells driving it. As every cell driven by an out of date cell is also out of date, the cells not visited
+            //are all up to date. Cells are marked up to date as they are visited, so that none is evaluated twice
+            vector<pair<CellId, int>> stack;
+            index.cellTimingDirty[target] = false;
+            stack.push_back(make_pair(target, 0));
+            while(!stack.empty()) {
+                CellId cell = stack.back().first;
+                bool descended = false;
+                if(index.GetCellKind(cell) != CELL_FLIPFLOP) {
+                    int inputCount = index.GetInputs(cell).size();
+                    while(stack.back().second < inputCount) {
+                        CellId driver = index.GetDriver(index.GetInput(cell, stack.back().second));
+                        stack.back().second++;
+                        if((driver != NoId) && index.cellTimingDirty[driver]) {
+                            index.cellTimingDirty[driver] = false;
+                            stack.push_back(make_pair(driver, 0));
+                            descended = true;
+                            break;
                         }
                     }
-                    if(indexInArray != -1) {
-                        devices.erase(devices.begin() + indexInArray);
-                    }
-                    for(auto inp : dtp->inputPorts) {
-                        inp->Disconnect();
+                }
+                if(!descended) {
+                    stack.pop_back();
+                    EvaluateCellTiming(index, cell);
+                }
+            }
+        }
+
+        void LogicDesign::MarkTimingDirty(NetlistIndex &index, CellId cell) {
+            //The outputs of flip flops don't depend on their inputs
+            if(index.cellTimingDirty[cell] || (index.GetCellKind(cell) == CELL_FLIPFLOP))
+                return;
+            //Propagation stops at cells already out of date, as those they drive must be out of date too. Only
+            //registers are added and connected to while pipelining, so the fanout of a net driven by any other cell
+            //is that found when the index was built, less any inputs since moved onto a register
+            vector<CellId> pending;
+            index.cellTimingDirty[cell] = true;
+            pending.push_back(cell);
+            while(!pending.empty()) {
+                CellId next = pending.back();
+                pending.pop_back();
+                for(auto output : index.GetOutputs(next)) {
+                    for(auto sink : index.GetFanout(output)) {
+                        if(!index.cellTimingDirty[sink] && (index.GetCellKind(sink) != CELL_FLIPFLOP) && index.HasInput(sink, output)) {
+                            index.cellTimingDirty[sink] = true;
+                            pending.push_back(sink);
+                        }
                     }
-                    for(auto outp : dtp->outputPorts) {
-                        outp->Disconnect();
+                }
+            }
+        }
+
+        void LogicDesign::AnalysePostPipelineTiming() {
+            NetlistIndex index(this);
+            vector<CellId> order;
+            vector<uint32_t> levelStart;
+            index.Levelize(order, levelStart);
+            AnalyseTimingLevelized(index, order, levelStart);
+            int cornerCount = index.GetCornerCount();
+            double worst_slack = numeric_limits<double>::infinity();
+            vector<double> cornerWorstSlack(cornerCount, numeric_limits<double>::infinity());
+            double TNS = 0;
+
+            //Each endpoint is reported at the corner where its slack is worst. Endpoints are the D inputs of flip
+            //flops, inputs of vendor specific devices that are registered inside the device, and top level outputs,
+            //which the pipeliner treats as registered outside the design
+            struct Endpoint {
+                double slack;
+                NetId net;
+                string name;
+                int corner;
+                bool operator<(const Endpoint &other) const { return slack < other.slack; };
+            };
+            vector<Endpoint> endpoints;
+            auto addEndpoint = [&](NetId d, const string &name) {
+                Endpoint endpoint = {numeric_limits<double>::infinity(), d, name, 0};
+                for(int c = 0; c < cornerCount; c++) {
+                    double budget = (1.0 / targetFrequency) - technology->GetSetupTime(c);
+                    double slack = budget - index.netDelay[c][d];
+                    index.netRequired[c][d] = min(index.netRequired[c][d], budget);
+                    cornerWorstSlack[c] = min(cornerWorstSlack[c], slack);
+                    if(slack < endpoint.slack) {
+                        endpoint.slack = slack;
+                        endpoint.corner = c;
                     }
                 }
-            } while(didOptimise);
+                if(endpoint.slack < worst_slack) {
+                    worst_slack = endpoint.slack;
+                }
+                if(endpoint.slack < 0) {
+                    TNS += -endpoint.slack;
+                }
+                endpoints.push_back(endpoint);
+            };
+            for(CellId cell = 0; cell < index.GetCellCount(); cell++) {
+                CellKind kind = index.GetCellKind(cell);
+                if((kind != CELL_FLIPFLOP) && (kind != CELL_VENDOR))
+                    continue;
+                IdRange<NetId> inputs = index.GetInputs(cell);
+                for(int i = 0; i < inputs.size(); i++) {
+                    if((kind == CELL_FLIPFLOP) ? (i != 0) : !static_cast<VendorSpecificDevice*>(index.GetCell(cell))->IsRegisteredInput(i))
+                        continue;
+                    addEndpoint(inputs[i], index.GetCell(cell)->name);
+                }
+            }
+            for(int i = 0; i < int(outputPorts.size()); i++) {
+                addEndpoint(index.GetOutputPortNet(i), "output " + outputPorts[i]->connectedNet->name);
+            }
+            PropagateRequiredTimes(index, order);
+            index.StoreTiming();
 
-            int lutTotal = 0, ffTotal = 0;
-            for(auto dev : devices) {
-                if(dynamic_cast<LUT*>(dev) != nullptr) {
-                    lutTotal++;
-                } else if(dynamic_cast<FlipFlop*>(dev) != nullptr) {
-                    ffTotal++;
+            string cornerSlacks = "";
+            if(cornerCount > 1) {
+                for(int c = 0; c < cornerCount; c++) {
+                    cornerSlacks += "\nworst setup slack at corner " + technology->GetCornerName(c) + " = " + to_string(cornerWorstSlack[c] * 1e9) + "ns";
+                }
+            }
+            worstSlack = worst_slack;
+            if(worst_slack >= 0) {
+                PrintMessage(MSG_NOTE,"pipelined design meets timing requirements\nworst setup slack = " + to_string(worst_slack * 1e9) + "ns" + cornerSlacks);
+            } else {
+                PrintMessage(MSG_WARNING,"pipelined design fails to meet timing requirements\nworst setup slack = " + to_string(worst_slack * 1e9) + "ns"
+                        + cornerSlacks + "\nTNS = " + to_string(TNS * 1e9) + "ns\nachievable frequency = "
+                        + to_string(1e-6 / ((1.0 / targetFrequency) - worst_slack)) + "MHz");
+
+            }
+
+            if(timingReportPaths > 0) {
+                int pathCount = min<int>(timingReportPaths, endpoints.size());
+                partial_sort(endpoints.begin(), endpoints.begin() + pathCount, endpoints.end());
+                string report;
+                for(int i = 0; i < pathCount; i++) {
+                    report += "Path " + to_string(i + 1) + ": " + ReportCriticalPath(index, endpoints[i].net, endpoints[i].name, endpoints[i].corner);
+                }
+                if(timingReportFile != "") {
+                    ofstream out(timingReportFile);
+                    out << report;
+                    if(out.fail()) {
+                        PrintMessage(MSG_ERROR, "failed to write timing report " + timingReportFile);
+                    }
+                } else {
+                    PrintMessage(MSG_NOTE, "worst paths:\n" + report);
                 }
             }
-            PrintMessage(MSG_NOTE, "optimised design contains " + to_string(lutTotal) + " LUT and " + to_string(ffTotal) + " FF");
         }
 
-        void LogicDesign::AnalyseTiming() {
-            set<LogicDevice*> analysed;
-            for(auto output : outputPorts) {
-                LogicDevice* outputDriver = output->connectedNet->GetDriver();
-                if(outputDriver != nullptr) {
-                    AnalyseTimingRecursive(outputDriver, false, analysed);
+        bool LogicDesign::GetCellTimingArc(NetlistIndex &index, CellId cell, int input, int output, int corner, double &routingDelay, double &cellDelay) {
+            switch(index.GetCellKind(cell)) {
+            case CELL_LUT: {
+                routingDelay = index.netRoutingDelay[corner][index.GetInputs(cell)[input]];
+                cellDelay = index.GetLUTPinDelays(cell, corner)[input];
+                return true;
+            }
+            case CELL_VENDOR:
+                return technology->GetTimingArc(static_cast<VendorSpecificDevice*>(index.GetCell(cell)), input, output, corner, routingDelay, cellDelay);
+            default:
+                return false;
+            }
+        }
+
+        void LogicDesign::PropagateRequiredTimes(NetlistIndex &index, const vector<CellId> &order) {
+            //Reverse topological order visits each cell after all the cells its outputs drive
+            for(int c = 0; c < index.GetCornerCount(); c++) {
+                vector<double> &netRequired = index.netRequired[c];
+                for(auto it = order.rbegin(); it != order.rend(); ++it) {
+                    CellId cell = *it;
+                    IdRange<NetId> inputs = index.GetInputs(cell), outputs = index.GetOutputs(cell);
+                    for(int j = 0; j < outputs.size(); j++) {
+                        if(netRequired[outputs[j]] == numeric_limits<double>::infinity())
+                            continue;
+                        for(int i = 0; i < inputs.size(); i++) {
+                            double routingDelay, cellDelay;
+                            if(GetCellTimingArc(index, cell, i, j, c, routingDelay, cellDelay)) {
+                                netRequired[inputs[i]] = min(netRequired[inputs[i]], netRequired[outputs[j]] - (routingDelay + cellDelay));
+                            }
+                        }
+                    }
                 }
             }
         }
 
-        void LogicDesign::AnalyseTimingRecursive(LogicDevice* target, bool stopAtRegister, set<LogicDevice*> &analysed) {
-            if(analysed.find(target) != analysed.end()) {
-                return;
+        string LogicDesign::ReportCriticalPath(NetlistIndex &index, NetId endNet, const string &endpoint, int corner) {
+            const vector<double> &netDelay = index.netDelay[corner], &netRequired = index.netRequired[corner];
+            //Trace the path back from the endpoint, at each cell following the input that sets its output delay
+            struct PathStage {
+                LogicDevice *dev;
+                NetId net;
+                double routingDelay, cellDelay;
+            };
+            vector<PathStage> stages;
+            NetId net = endNet;
+            for(int steps = 0; steps < index.GetCellCount(); steps++) {
+                CellId cell = index.GetDriver(net);
+                PathStage stage = {nullptr, net, 0, netDelay[net]};
+                if(cell == NoId) {
+                    //Driven by a top level input or constant
+                    stages.push_back(stage);
+                    break;
+                }
+                stage.dev = index.GetCell(cell);
+                IdRange<NetId> inputs = index.GetInputs(cell), outputs = index.GetOutputs(cell);
+                int output = find(outputs.begin(), outputs.end(), net) - outputs.begin();
+                int worstInput = -1;
+                double worstArrival = -numeric_limits<double>::infinity();
+                for(int i = 0; i < inputs.size(); i++) {
+                    double routingDelay, cellDelay;
+                    if(GetCellTimingArc(index, cell, i, output, corner, routingDelay, cellDelay) &&
+                        ((netDelay[inputs[i]] + routingDelay + cellDelay) > worstArrival)) {
+                        worstArrival = netDelay[inputs[i]] + routingDelay + cellDelay;
+                        worstInput = i;
+                        stage.routingDelay = routingDelay;
+                        stage.cellDelay = cellDelay;
+                    }
+                }
+                stages.push_back(stage);
+                if(worstInput == -1)
+                    break;
+                net = inputs[worstInput];
             }
-            analysed.insert(target);
-            LUT* lut = dynamic_cast<LUT*>(target);
-            FlipFlop *ff = dynamic_cast<FlipFlop*>(target);
-            for(auto inp : target->inputPorts) {
-                LogicDevice* outputDriver = inp->connectedNet->GetDriver();
-                if(outputDriver != nullptr) {
-                    if(stopAtRegister && (ff != nullptr))
-                        continue;
-                    AnalyseTimingRecursive(outputDriver, stopAtRegister, analysed);
+            reverse(stages.begin(), stages.end());
+
+            //Delay is totalled by type, to show whether logic, routing or hard blocks limit the path
+            double lutDelay = 0, routingDelay = 0, carryDelay = 0, dspDelay = 0, registerDelay = 0, otherDelay = 0;
+            stringstream report;
+            report << fixed << setprecision(3);
+            report << "slack = " << (netRequired[endNet] - netDelay[endNet]) * 1e9 << "ns, arrival = "
+                   << netDelay[endNet] * 1e9 << "ns, required = " << netRequired[endNet] * 1e9
+                   << "ns, endpoint " << endpoint;
+            if(index.GetCornerCount() > 1) {
+                report << ", corner " << technology->GetCornerName(corner);
+            }
+            report << endl;
+            report << "    routing     cell  arrival  type      device            net" << endl;
+            for(auto &stage : stages) {
+                string type = "input";
+                if(stage.dev != nullptr) {
+                    switch(stage.dev->kind) {
+                    case DEVICE_LUT:
+                        type = "LUT";
+                        lutDelay += stage.cellDelay;
+                        break;
+                    case DEVICE_FLIPFLOP:
+                        type = "FF";
+                        registerDelay += stage.cellDelay;
+                        break;
+                    case DEVICE_XILINX_SRL:
+                    case DEVICE_ALTERA_SHIFTTAPS:
+                        type = "shiftreg";
+                        registerDelay += stage.cellDelay;
+                        break;
+                    case DEVICE_XILINX_CARRY4:
+                    case DEVICE_ALTERA_CARRYSUM:
+                        type = "carry";
+                        carryDelay += stage.cellDelay;
+                        break;
+                    case DEVICE_XILINX_DSP48MUL:
+                    case DEVICE_ALTERA_MULTIPLIER18:
+                        type = "DSP";
+                        dspDelay += stage.cellDelay;
+                        break;
+                    default:
+                        type = "other";
+                        otherDelay += stage.cellDelay;
+                        break;
+                    }
+                } else {
+                    otherDelay += stage.cellDelay;
                 }
+                routingDelay += stage.routingDelay;
+                report << "  " << setw(9) << stage.routingDelay * 1e9 << setw(9) << stage.cellDelay * 1e9
+                       << setw(9) << netDelay[stage.net] * 1e9 << "  " << left << setw(8) << type << "  "
+                       << setw(16) << ((stage.dev != nullptr) ? stage.dev->name : "") << "  " << index.GetNet(stage.net)->name
+                       << right << endl;
             }
+            report << "  LUT " << lutDelay * 1e9 << "ns, routing " << routingDelay * 1e9 << "ns, carry " << carryDelay * 1e9
+                   << "ns, DSP " << dspDelay * 1e9 << "ns, register " << registerDelay * 1e9 << "ns, other "
+                   << otherDelay * 1e9 << "ns" << endl;
+            return report.str();
+        }
 
-            if(lut != nullptr) {
-                //Consider routing delays, different depending on input origin
-                double worst_input_tpd = 0;
-                for(auto input : lut->inputPorts) {
-                    LogicDevice* outputDriver = input->connectedNet->GetDriver();
-                    if(outputDriver != nullptr) {
-                        if(dynamic_cast<LUT*>(outputDriver) != nullptr) {
-                            worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay + technology->GetRoutingDelay_LUT_LUT());
+        void LogicDesign::PipelineDesign() {
+            ArenaScope scope(&arena);
+            //The timing of every device is brought up to date before starting, and then kept up to date as
+            //registers are inserted
+            AnalyseTiming();
+            pipelineLatency = 0;
+            if(!allowPipeline) {
+                InferShiftRegisters();
+                return;
+            }
+            if(clockSignal == nullptr) {
+                PrintMessage(MSG_WARNING, "pipeline not possible without global clock signal");
+                InferShiftRegisters();
+                return;
+            }
+            OrderLatencyConstraints();
+            //Latency limits are met by pipelining for a different frequency, starting again from the synthesised
+            //netlist each time. Pipelining for a lower frequency needs fewer registers, and for a higher frequency
+            //spreads more registers along the longest paths
+            if((maxLatency >= 0) && (minLatency > maxLatency)) {
+                PrintMessage(MSG_ERROR, "minimum latency of " + to_string(minLatency) + " and maximum latency of " + to_string(maxLatency) + " can't both be met");
+            }
+            BinaryWriter snapshot;
+            if((maxLatency >= 0) || (minLatency > 0)) {
+                WriteNetlist(snapshot, DESIGN_SYNTHESISED);
+            }
+            double pipelinedFrequency = targetFrequency;
+            int latency = PipelineAtFrequency(targetFrequency);
+            auto pipelineAt = [&](double frequency) {
+                RestoreNetlist(snapshot);
+                pipelinedFrequency = frequency;
+                latency = PipelineAtFrequency(frequency);
+                return latency;
+            };
+            if((maxLatency >= 0) && (latency > maxLatency)) {
+                //With no timing budget, only the registers the design itself needs are left
+                if(pipelineAt(0) > maxLatency) {
+                    PrintMessage(MSG_WARNING, "maximum latency of " + to_string(maxLatency) + " can't be met, as the design has a latency of at least " + to_string(latency));
+                } else {
+                    double low = 0, high = targetFrequency;
+                    for(int i = 0; i < LatencySearchSteps; i++) {
+                        double mid = (low + high) / 2;
+                        if(pipelineAt(mid) <= maxLatency) {
+                            low = mid;
                         } else {
-                            worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay);
+                            high = mid;
                         }
-                    } else {
-                        worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay);
                     }
+                    if(pipelinedFrequency != low) {
+                        pipelineAt(low);
+                    }
+                    PrintMessage(MSG_WARNING, "pipelined for " + to_string(low / 1e6) + "MHz to meet maximum latency of " + to_string(maxLatency));
                 }
-                lut->outputPorts[0]->connectedNet->delay = worst_input_tpd + technology->GetLUTTpd(lut);
-            } else if(ff != nullptr) {
-                ff->outputPorts[0]->connectedNet->delay = technology->GetFFTpd();
-            } else {
-                VendorSpecificDevice *vsd = dynamic_cast<VendorSpecificDevice*>(target);
-                if(vsd != nullptr) {
-                    technology->AnalyseTiming(vsd, this);
+            } else if(latency < minLatency) {
+                //Latency goes up in steps with frequency, so a frequency giving exactly the minimum latency may not
+                //exist. The highest frequency found giving less is then used, and the outputs padded to the minimum,
+                //which needs fewer registers than overshooting it and can't break the maximum latency
+                double low = targetFrequency, high = targetFrequency;
+                int lastLatency = latency, highLatency = latency;
+                bool reached = false;
+                for(int i = 0; (i < LatencySearchSteps) && !reached; i++) {
+                    low = high;
+                    high *= 2;
+                    reached = (pipelineAt(high) >= minLatency);
+                    highLatency = latency;
+                    //Stop once every path is already pipelined as much as it can be
+                    if(latency == lastLatency)
+                        break;
+                    lastLatency = latency;
+                }
+                if(reached) {
+                    for(int i = 0; i < LatencySearchSteps; i++) {
+                        double mid = (low + high) / 2;
+                        if(pipelineAt(mid) >= minLatency) {
+                            high = mid;
+                            highLatency = latency;
+                        } else {
+                            low = mid;
+                        }
+                    }
+                    double best = (highLatency == minLatency) ? high : low;
+                    if(pipelinedFrequency != best) {
+                        pipelineAt(best);
+                    }
+                }
+                if(pipelinedFrequency != targetFrequency) {
+                    PrintMessage(MSG_NOTE, "pipelined for " + to_string(pipelinedFrequency / 1e6) + "MHz to meet minimum latency of " + to_string(minLatency));
+                }
+            }
+            if(latency < minLatency) {
+                //Any latency still missing is made up with registers at the outputs, which retiming may then move
+                PrintMessage(MSG_NOTE, "adding " + to_string(minLatency - latency) + " cycles of registers at the outputs to meet minimum latency of " + to_string(minLatency));
+                for(auto output : outputPorts) {
+                    if((output->connectedNet != gnd) && (output->connectedNet != vcc) && (!output->connectedNet->isSlow) && (output->latcons.size() == 0)) {
+                        while(output->connectedNet->latency < minLatency) {
+                            Signal *pipelined = PipelineSignal(output->connectedNet);
+                            output->Disconnect();
+                            output->Connect(pipelined);
+                        }
+                    }
+                    latency = max(latency, output->connectedNet->latency);
                 }
             }
-        }
 
-        void LogicDesign::AnalysePostPipelineTiming() {
-            set<LogicDevice*> analysed;
-            double worst_slack = numeric_limits<double>::infinity();
-            double TNS = 0;
+            for(auto sig : signals) {
+                sig->pipelined = nullptr;
+            }
+            //The greedy result meets the budget, so is the starting point for reducing the number of registers
+            if(minimiseRegisters || allowRetime) {
+                vector<int> outputLatency;
+                for(auto output : outputPorts) {
+                    outputLatency.push_back(output->connectedNet->latency);
+                }
+                Retimer retimer(this, minimiseRegisters);
+                retimer.Run();
+                latency = 0;
+                for(int i = 0; i < outputPorts.size(); i++) {
+                    latency = max(latency, outputLatency[i] + retimer.GetLatencyChange(outputPorts[i]));
+                }
+            }
+            pipelineLatency = latency;
+            PrintMessage(MSG_NOTE, "pipeline latency is " + to_string(latency));
+            InferShiftRegisters();
 
+            int lutTotal = 0, ffTotal = 0;
             for(auto dev : devices) {
-                FlipFlop *ff = dynamic_cast<FlipFlop*>(dev);
-                if(ff != nullptr) {
-                    LogicDevice *drv = ff->inputPorts[0]->connectedNet->GetDriver();
-                    if(drv != nullptr) {
-                        AnalyseTimingRecursive(drv, true, analysed);
-                    }
-                    double budget = (1.0 / targetFrequency) - technology->GetFFSetupTime();
-                    double slack = budget - ff->inputPorts[0]->connectedNet->delay;
-                    if(slack < worst_slack) {
-                        worst_slack = slack;
-                    }
-                    if(slack < 0) {
-                        TNS += -slack;
+                if(dev->kind == DEVICE_LUT) {
+                    lutTotal++;
+                } else if(dev->kind == DEVICE_FLIPFLOP) {
+                    ffTotal++;
+                }
+            }
+            PrintMessage(MSG_NOTE, "pipelined design contains " + to_string(lutTotal) + " LUT and " + to_string(ffTotal) + " FF");
+        }
+
+        void LogicDesign::InferShiftRegisters() {
+            if(!allowShiftRegisters) return;
+            //Return the register following a register in a chain, or nullptr if there is none. Registers in a chain
+            //have no reset, the same clock and enable, and each drives nothing but the D input of the next
+            auto getEnable = [](FlipFlop *ff) -> Signal* {
+                return ff->hasEnable ? ff->inputPorts[2]->connectedNet : nullptr;
+            };
+            auto getNext = [&](FlipFlop *ff) -> FlipFlop* {
+                Signal *q = ff->outputPorts[0]->connectedNet;
+                if((q->GetFanout() != 1) || (q->GetDriverCount() != 1))
+                    return nullptr;
+                DeviceInputPort *sink = dynamic_cast<DeviceInputPort*>(q->fanout[0]);
+                if((sink == nullptr) || (sink->device == ff) || (sink->device->kind != DEVICE_FLIPFLOP) || (sink != sink->device->inputPorts[0]))
+                    return nullptr;
+                FlipFlop *next = static_cast<FlipFlop*>(sink->device);
+                if(next->hasReset || (next->inputPorts[1]->connectedNet != ff->inputPorts[1]->connectedNet) || (getEnable(next) != getEnable(ff)))
+                    return nullptr;
+                return next;
+            };
+
+            vector<FlipFlop*> candidates;
+            unordered_set<FlipFlop*> hasPrevious;
+            for(auto dev : devices) {
+                FlipFlop *ff = DeviceCast<FlipFlop>(dev);
+                if((ff != nullptr) && !ff->hasReset) {
+                    candidates.push_back(ff);
+                    FlipFlop *next = getNext(ff);
+                    if(next != nullptr) {
+                        hasPrevious.insert(next);
                     }
                 }
             }
 
-            if(worst_slack >= 0) {
-                PrintMessage(MSG_NOTE,"pipelined design meets timing requirements\nworst setup slack = " + to_string(worst_slack * 1e9) + "ns");
-            } else {
-                PrintMessage(MSG_WARNING,"pipelined design fails to meet timing requirements\nworst setup slack = " + to_string(worst_slack * 1e9) + "ns\n"
-                        + "TNS = " + to_string(TNS * 1e9) + "ns");
+            //The first and last register of each chain are kept, so that the timing of the paths into and out of the
+            //chain is unchanged, and the rest replaced. Chains replaced by shift registers of the same depth, clock
+            //and enable are grouped together
+            struct ChainGroup {
+                Signal *clock, *enable;
+                int depth;
+                vector<vector<FlipFlop*>> chains;
+            };
+            vector<ChainGroup> groups;
+            map<tuple<Signal*, Signal*, int>, int> groupIndex;
+            for(auto ff : candidates) {
+                if(hasPrevious.find(ff) != hasPrevious.end())
+                    continue;
+                vector<FlipFlop*> chain{ff};
+                for(FlipFlop *next = getNext(ff); next != nullptr; next = getNext(next)) {
+                    chain.push_back(next);
+                }
+                int depth = chain.size() - 2;
+                if(depth < 1)
+                    continue;
+                auto key = make_tuple(ff->inputPorts[1]->connectedNet, getEnable(ff), depth);
+                if(groupIndex.find(key) == groupIndex.end()) {
+                    groupIndex[key] = groups.size();
+                    ChainGroup group = {get<0>(key), get<1>(key), depth};
+                    groups.push_back(group);
+                }
+                groups[groupIndex[key]].chains.push_back(chain);
+            }
 
+            unordered_set<LogicDevice*> removed;
+            int deviceCount = devices.size();
+            for(auto &group : groups) {
+                if(!technology->IsShiftRegisterSuitable(group.chains.size(), group.depth))
+                    continue;
+                vector<Signal*> D, Q;
+                for(auto &chain : group.chains) {
+                    D.push_back(chain.front()->outputPorts[0]->connectedNet);
+                    Q.push_back(chain[chain.size() - 2]->outputPorts[0]->connectedNet);
+                    for(int i = 1; i < chain.size() - 1; i++) {
+                        chain[i]->RemoveDevice();
+                        removed.insert(chain[i]);
+                    }
+                }
+                technology->SynthesiseShiftRegister(D, Q, group.depth, group.clock, group.enable, this);
             }
-        }
-
-        void LogicDesign::PipelineDesign() {
-            if(!allowPipeline) return;
-            if(clockSignal == nullptr) {
-                PrintMessage(MSG_WARNING, "pipeline not possible without global clock signal");
+            if(removed.empty())
                 return;
+            int shiftRegisterCount = devices.size() - deviceCount;
+            devices.erase(remove_if(devices.begin(), devices.end(), [&](LogicDevice *dev) { return removed.find(dev) != removed.end(); }), devices.end());
+            for(auto dev : removed) {
+                DestroyDevice(dev);
             }
+            PrintMessage(MSG_NOTE, "replaced " + to_string(removed.size()) + " FF in register chains with " + to_string(shiftRegisterCount) + " shift registers");
+        }
 
-            //Process latency constraints first (TODO: complex chains of constraints)
-            for(auto latcon : latcons) {
-              int maxLatency = 0;
-              for(auto output : latcon->outputs) {
-                  LogicDevice* outputDriver = output->connectedNet->GetDriver();
-                  if(outputDriver != nullptr) {
-                      PipelineDesignRecursive(outputDriver);
-                  }
-                  maxLatency = max(maxLatency, output->connectedNet->latency);
+        int LogicDesign::PipelineAtFrequency(double frequency) {
+            pipelineFrequency = frequency;
+            NetlistIndex index(this);
+            auto outputIndex = [this](DesignOutputPort *output) -> int {
+                return find(outputPorts.begin(), outputPorts.end(), output) - outputPorts.begin();
+            };
+            auto canDelay = [this, &index](NetId net) {
+                return (index.GetNet(net) != gnd) && (index.GetNet(net) != vcc) && !index.netSlow[net];
+            };
+
+            //Process latency constraints first, so that the latency of their inputs is known before pipelining
+            //anything they drive
+            for(auto &group : latconGroups) {
+              int latconLatency = 0;
+              for(int i : group) {
+                for(auto output : latcons[i]->outputs) {
+                    NetId net = index.GetOutputPortNet(outputIndex(output));
+                    CellId outputDriver = index.GetDriver(net);
+                    if(outputDriver != NoId) {
+                        PipelineDesignRecursive(index, outputDriver);
+                    }
+                    latconLatency = max(latconLatency, index.netLatency[net]);
+                }
               }
-              PrintMessage(MSG_DEBUG, "latency for latcon == " + to_string(maxLatency));
-              for(auto output : latcon->outputs) {
-                  if((output->connectedNet != gnd) && (output->connectedNet != vcc) && (!output->connectedNet->isSlow)) {
-                      while(output->connectedNet->latency < maxLatency) {
-                          Signal *pipelined = PipelineSignal(output->connectedNet);
-                          output->Disconnect();
-                          output->connectedNet = pipelined;
-                          pipelined->connectedPorts.push_back(output);
-                      }
-                  }
+              PrintMessage(MSG_DEBUG, "latency for latcon == " + to_string(latconLatency));
+              for(int i : group) {
+                for(auto output : latcons[i]->outputs) {
+                    int port = outputIndex(output);
+                    if(canDelay(index.GetOutputPortNet(port))) {
+                        DelayOutput(index, port, latconLatency);
+                    }
+                }
               }
 
-              for(auto input : latcon->inputs) {
-                input->connectedNet->latency = maxLatency + latcon->ext_latency;
+              for(int i : group) {
+                for(auto input : latcons[i]->inputs) {
+                  int port = find(inputPorts.begin(), inputPorts.end(), input) - inputPorts.begin();
+                  index.netLatency[index.GetInputPortNet(port)] = latconLatency + latcons[i]->ext_latency;
+                }
               }
             }
 
-            for(auto output : outputPorts) {
-                if(output->latcons.size() == 0) {
-                  LogicDevice* outputDriver = output->connectedNet->GetDriver();
-                  if(outputDriver != nullptr) {
-                      PipelineDesignRecursive(outputDriver);
+            for(int port = 0; port < int(outputPorts.size()); port++) {
+                if(outputPorts[port]->latcons.size() == 0) {
+                  CellId outputDriver = index.GetDriver(index.GetOutputPortNet(port));
+                  if(outputDriver != NoId) {
+                      PipelineDesignRecursive(index, outputDriver);
                   }
                 }
 
             }
-            int maxLatency = 0;
-            for(auto output : outputPorts) {
-                maxLatency = max(maxLatency, output->connectedNet->latency);
+            int latency = 0;
+            for(int port = 0; port < int(outputPorts.size()); port++) {
+                latency = max(latency, index.netLatency[index.GetOutputPortNet(port)]);
             }
-            PrintMessage(MSG_NOTE, "pipeline latency is " + to_string(maxLatency));
 
+            for(int port = 0; port < int(outputPorts.size()); port++) {
+                if(canDelay(index.GetOutputPortNet(port)) && (outputPorts[port]->latcons.size() == 0)) {
+                    DelayOutput(index, port, latency);
+                }
+            }
+
+            index.StoreTiming();
+            for(CellId cell = 0; cell < index.GetCellCount(); cell++) {
+                index.GetCell(cell)->pipelineDone = index.cellPipelineDone[cell];
+            }
+            return latency;
+        }
+
+        void LogicDesign::OrderLatencyConstraints() {
+            latconGroups.clear();
+            unordered_map<LatencyConstraint*, int> latconIndex;
+            for(int i = 0; i < latcons.size(); i++) {
+                latconIndex[latcons[i]] = i;
+            }
+            //Group constraints sharing an output, numbering the groups in the order of their first constraint
+            vector<int> parent(latcons.size());
+            for(int i = 0; i < latcons.size(); i++) {
+                parent[i] = i;
+            }
+            function<int(int)> findRoot = [&](int i) {
+                return (parent[i] == i) ? i : (parent[i] = findRoot(parent[i]));
+            };
             for(auto output : outputPorts) {
-                if((output->connectedNet != gnd) && (output->connectedNet != vcc) && (!output->connectedNet->isSlow) && (output->latcons.size() == 0)) {
-                    while(output->connectedNet->latency < maxLatency) {
-                        Signal *pipelined = PipelineSignal(output->connectedNet);
-                        output->Disconnect();
-                        output->connectedNet = pipelined;
-                        pipelined->connectedPorts.push_back(output);
+                for(auto latcon : output->latcons) {
+                    int a = findRoot(latconIndex[output->latcons[0]]), b = findRoot(latconIndex[latcon]);
+                    parent[max(a, b)] = min(a, b);
+                }
+            }
+            vector<vector<int>> groups;
+            vector<int> groupOf(latcons.size());
+            unordered_map<int, int> groupOfRoot;
+            for(int i = 0; i < latcons.size(); i++) {
+                int root = findRoot(i);
+                if(groupOfRoot.find(root) == groupOfRoot.end()) {
+                    groupOfRoot[root] = groups.size();
+                    groups.push_back(vector<int>());
+                }
+                groupOf[i] = groupOfRoot[root];
+                groups[groupOf[i]].push_back(i);
+            }
+
+            //A group depends on the groups whose inputs are found by following its outputs back through the design
+            vector<set<int>> dependsOn(groups.size());
+            for(int g = 0; g < groups.size(); g++) {
+                unordered_set<Signal*> visited;
+                vector<Signal*> pending;
+                for(int i : groups[g]) {
+                    for(auto output : latcons[i]->outputs) {
+                        pending.push_back(output->connectedNet);
+                    }
+                }
+                while(!pending.empty()) {
+                    Signal *net = pending.back();
+                    pending.pop_back();
+                    if(!visited.insert(net).second)
+                        continue;
+                    DesignInputPort *input = dynamic_cast<DesignInputPort*>(net->driver);
+                    if((input != nullptr) && (input->latcon != nullptr)) {
+                        dependsOn[g].insert(groupOf[latconIndex[input->latcon]]);
+                    }
+                    LogicDevice *driver = net->GetDriver();
+                    if(driver != nullptr) {
+                        for(auto inp : driver->inputPorts) {
+                            pending.push_back(inp->connectedNet);
+                        }
                     }
                 }
             }
 
-            int lutTotal = 0, ffTotal = 0;
-            for(auto dev : devices) {
-                if(dynamic_cast<LUT*>(dev) != nullptr) {
-                    lutTotal++;
-                } else if(dynamic_cast<FlipFlop*>(dev) != nullptr) {
-                    ffTotal++;
+            //Tarjan's algorithm finds each strongly connected component of the dependency graph after every component
+            //it depends on, which is the order they must be solved in
+            vector<int> index(groups.size(), -1), lowLink(groups.size(), 0);
+            vector<bool> onStack(groups.size(), false);
+            vector<int> stack;
+            int nextIndex = 0;
+            auto describe = [&](int g) {
+                string description;
+                for(int i : groups[g]) {
+                    LatencyConstraint *latcon = latcons[i];
+                    description += (description == "") ? "" : ", ";
+                    description += "LATCON " + (latcon->outputs.empty() ? string("?") : latcon->outputs[0]->linkedIO->IOName) + " "
+                            + (latcon->inputs.empty() ? string("?") : latcon->inputs[0]->linkedIO->IOName);
+                }
+                return description;
+            };
+            function<void(int)> visit = [&](int g) {
+                index[g] = lowLink[g] = nextIndex++;
+                stack.push_back(g);
+                onStack[g] = true;
+                for(int d : dependsOn[g]) {
+                    if(index[d] == -1) {
+                        visit(d);
+                        lowLink[g] = min(lowLink[g], lowLink[d]);
+                    } else if(onStack[d]) {
+                        lowLink[g] = min(lowLink[g], index[d]);
+                    }
+                }
+                if(lowLink[g] != index[g])
+                    return;
+                vector<int> component;
+                int member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    component.push_back(member);
+                } while(member != g);
+                sort(component.begin(), component.end());
+                if((component.size() > 1) || (dependsOn[g].count(g) != 0)) {
+                    //The latency of the outputs of a constraint can't be less than that of the inputs they depend on,
+                    //so if every constraint adds external latency, the latency would have to go up each time round
+                    int minExternalLatency = numeric_limits<int>::max();
+                    string description;
+                    for(int c : component) {
+                        for(int i : groups[c]) {
+                            minExternalLatency = min(minExternalLatency, latcons[i]->ext_latency);
+                        }
+                        description += ((description == "") ? "" : ", ") + describe(c);
+                    }
+                    if((component.size() == 1) && (groups[g].size() == 1)) {
+                        PrintMessage(MSG_WARNING, "latency constraint " + description + " has outputs depending on its own inputs, so "
+                                + ((minExternalLatency > 0) ? "can't be met" : "may not be met"));
+                    } else if(minExternalLatency > 0) {
+                        PrintMessage(MSG_WARNING, "latency constraints " + description + " depend on each other in a cycle through external latency, so can't all be met");
+                    } else {
+                        PrintMessage(MSG_WARNING, "latency constraints " + description + " depend on each other in a cycle, so may not all be met");
+                    }
+                }
+                for(int c : component) {
+                    latconGroups.push_back(groups[c]);
+                }
+            };
+            for(int g = 0; g < groups.size(); g++) {
+                if(index[g] == -1) {
+                    visit(g);
                 }
             }
-            PrintMessage(MSG_NOTE, "pipelined design contains " + to_string(lutTotal) + " LUT and " + to_string(ffTotal) + " FF");
         }
 
-        void LogicDesign::PipelineDesignRecursive(LogicDevice* target) {
-            LUT* lut = dynamic_cast<LUT*>(target);
-            FlipFlop *ff = dynamic_cast<FlipFlop*>(target);
-            //TODO: make a generic interface for pipelining ROMs etc
-            Altera_ROM *rom = dynamic_cast<Altera_ROM*>(target);
+        void LogicDesign::RestoreNetlist(const BinaryWriter &snapshot) {
+            ClearNetlist();
+            BinaryReader in(snapshot.GetData().data(), snapshot.GetData().data() + snapshot.GetData().size());
+            if(!ReadNetlist(in)) {
+                PrintMessage(MSG_ERROR, "failed to restore netlist");
+            }
+            AnalyseTiming();
+        }
+
+        double LogicDesign::GetPipelineBudget(int corner) {
+            return (timingBudget / pipelineFrequency) - (timingSlack + technology->GetSetupTime(corner));
+        }
+
+        void LogicDesign::PipelineDesignRecursive(NetlistIndex &index, CellId target) {
             int maxInputLatency = 0;
-            if(target->pipelineDone)
+            if(index.cellPipelineDone[target])
                 return;
-            target->pipelineDone = true;
+            index.cellPipelineDone[target] = true;
             bool allAreSlow = true;
-            for(auto inp : target->inputPorts) {
-                LogicDevice* outputDriver = inp->connectedNet->GetDriver();
-                if(outputDriver != nullptr) {
-                    PipelineDesignRecursive(outputDriver);
+            //Inputs are looked up by position each time, as registers added while pipelining the drivers move the
+            //connections of the index
+            int inputCount = index.GetInputs(target).size();
+            for(int i = 0; i < inputCount; i++) {
+                CellId outputDriver = index.GetDriver(index.GetInput(target, i));
+                if(outputDriver != NoId) {
+                    PipelineDesignRecursive(index, outputDriver);
                 }
-                if(!inp->connectedNet->isSlow) {
+                NetId net = index.GetInput(target, i);
+                if(!index.netSlow[net]) {
                   allAreSlow = false;
                 }
-                maxInputLatency = max(maxInputLatency, inp->connectedNet->latency);
+                maxInputLatency = max(maxInputLatency, index.netLatency[net]);
             }
-
-            if(ff != nullptr) {
-                if(ff->isShift) {
-                    target->outputPorts[0]->connectedNet->latency = target->inputPorts[0]->connectedNet->latency;
+            auto canDelay = [this, &index](NetId net) {
+                return (index.GetNet(net) != gnd) && (index.GetNet(net) != vcc) && !index.netSlow[net];
+            };
+
+            switch(index.GetCellKind(target)) {
+            case CELL_FLIPFLOP:
+                if(static_cast<FlipFlop*>(index.GetCell(target))->isShift) {
+                    index.netLatency[index.GetOutputs(target)[0]] = index.netLatency[index.GetInput(target, 0)];
                 } else {
-                    target->outputPorts[0]->connectedNet->latency = target->inputPorts[0]->connectedNet->latency + 1;
+                    index.netLatency[index.GetOutputs(target)[0]] = index.netLatency[index.GetInput(target, 0)] + 1;
                 }
                 return; //don't pipeline flip flops
-            } else if(rom != nullptr) {
-                for(int i = 1; i < rom->inputPorts.size(); i++) {
-                    DeviceInputPort *inp = rom->inputPorts[i];
-                    if((inp->connectedNet != gnd) && (inp->connectedNet != vcc) && (!inp->connectedNet->isSlow)) {
-                        while(inp->connectedNet->latency < maxInputLatency) {
-                            PipelinePin(inp);
+            case CELL_VENDOR:
+                if(index.GetCell(target)->kind == DEVICE_ALTERA_ROM) {
+                    //TODO: make a generic interface for pipelining ROMs etc
+                    for(int i = 1; i < inputCount; i++) {
+                        if(canDelay(index.GetInput(target, i))) {
+                            DelayPin(index, target, i, maxInputLatency);
                         }
                     }
+                    for(auto output : index.GetOutputs(target)) {
+                        index.netLatency[output] = maxInputLatency + 1;
+                    }
+                    return;
                 }
-                for(auto op : rom->outputPorts) {
-                    op->connectedNet->latency = maxInputLatency + 1;
-                }
-                return;
+                break;
+            default:
+                break;
             }
 
-            for(auto inp : target->inputPorts) {
-                if((inp->connectedNet != gnd) && (inp->connectedNet != vcc) && (!inp->connectedNet->isSlow)) {
-                    while(inp->connectedNet->latency < maxInputLatency) {
-                        PipelinePin(inp);
-                    }
+            for(int i = 0; i < inputCount; i++) {
+                if(canDelay(index.GetInput(target, i))) {
+                    DelayPin(index, target, i, maxInputLatency);
                 }
 
             }
-            set<LogicDevice*> analysed;
-            AnalyseTimingRecursive(target, true, analysed);
+            AnalyseConeTiming(index, target);
 
 
-            double totalBudget = (timingBudget / targetFrequency) - (timingSlack + technology->GetFFSetupTime());
+            //Registers are inserted if any output misses the budget at any corner, so that timing is met at the worst
             bool needPipeline = false;
-            for(auto outp : target->outputPorts) {
-                outp->connectedNet->latency = maxInputLatency;
-                if(outp->connectedNet->delay >= totalBudget) {
-                    needPipeline = true;
+            for(int c = 0; c < technology->GetCornerCount(); c++) {
+                double totalBudget = GetPipelineBudget(c);
+                for(auto output : index.GetOutputs(target)) {
+                    if(index.netDelay[c][output] >= totalBudget) {
+                        needPipeline = true;
+                    }
                 }
             }
+            for(auto output : index.GetOutputs(target)) {
+                index.netLatency[output] = maxInputLatency;
+            }
             if(allAreSlow) {
               //Propogate 'slow' status through gates
-              for(auto outp : target->outputPorts) {
-                  outp->connectedNet->isSlow = true;
+              for(auto output : index.GetOutputs(target)) {
+                  index.netSlow[output] = true;
               }
             } else {
               if(needPipeline) {
-                  for(auto inp : target->inputPorts) {
-                      PipelinePin(inp);
+                  for(int i = 0; i < inputCount; i++) {
+                      PipelinePin(index, target, i);
                   }
 
-                  for(auto outp : target->outputPorts) {
-                      outp->connectedNet->latency = maxInputLatency + 1;
+                  for(auto output : index.GetOutputs(target)) {
+                      index.netLatency[output] = maxInputLatency + 1;
                   }
               }
             }
@@ -679,16 +1568,20 @@ namespace SynthFramework {
             } else if(source == vcc) {
                 return vcc;
             }
+            if(source->pipelined != nullptr) {
+                return source->pipelined;
+            }
             //This avoids creating a duplicate pipeline register if a perfectly good one already exists
-            for(auto port : source->connectedPorts) {
+            for(auto port : source->fanout) {
                 DeviceInputPort *dip = dynamic_cast<DeviceInputPort*>(port);
                 if(dip != nullptr) {
-                    FlipFlop *ff = dynamic_cast<FlipFlop*>(dip->device);
+                    FlipFlop *ff = DeviceCast<FlipFlop>(dip->device);
                     if(ff != nullptr) {
                         //Check the flip flop is not in any way funky. Once these signals start being used it should also check
                         //that if global enable/reset are used then these are connected correctly
                         if((dip == ff->inputPorts[0]) && (ff->inputPorts[1]->connectedNet == clockSignal) && (ff->hasReset == globalHasReset) && (ff->hasEnable == globalHasEnable)) {
-                            return ff->outputPorts[0]->connectedNet;
+                            source->pipelined = ff->outputPorts[0]->connectedNet;
+                            return source->pipelined;
                         }
                     }
                 }
@@ -696,25 +1589,83 @@ namespace SynthFramework {
             //Assume at this point no suitable register exists already, so create one
             Signal *reg = CreateSignal(source->name + "_reg");
             FlipFlop *newff = new FlipFlop(source, clockSignal, reg);
-            devices.push_back(newff);
+            AddDevice(newff);
+            source->pipelined = reg;
             reg->latency = source->latency + 1;
+            for(int c = 0; c < technology->GetCornerCount(); c++) {
+                reg->delay[c] = technology->GetClockToOutDelay(c);
+            }
             return reg;
         }
 
-        void LogicDesign::PipelinePin(DeviceInputPort* port) {
-            Signal *pipelined = PipelineSignal(port->connectedNet);
+        NetId LogicDesign::PipelineNet(NetlistIndex &index, NetId net) {
+            Signal *source = index.GetNet(net);
+            if((source == gnd) || (source == vcc))
+                return net;
+            if(index.netPipelined[net] != NoId)
+                return index.netPipelined[net];
+            size_t deviceCount = devices.size();
+            Signal *reg = PipelineSignal(source);
+            NetId pipelined = NoId;
+            if(devices.size() > deviceCount) {
+                CellId cell = index.AddCell(devices.back(), {net, index.GetClockNet()});
+                pipelined = index.GetOutputs(cell)[0];
+                index.netLatency[pipelined] = index.netLatency[net] + 1;
+            } else {
+                //A suitable register was already connected to the net when the index was built
+                for(auto sink : index.GetFanout(net)) {
+                    if(index.GetCell(sink) == reg->GetDriver()) {
+                        pipelined = index.GetOutputs(sink)[0];
+                        break;
+                    }
+                }
+            }
+            index.netPipelined[net] = pipelined;
+            return pipelined;
+        }
+
+        void LogicDesign::PipelinePin(NetlistIndex &index, CellId cell, int pin) {
+            NetId pipelined = PipelineNet(index, index.GetInput(cell, pin));
+            DeviceInputPort *port = index.GetCell(cell)->inputPorts[pin];
             port->Disconnect();
-            port->connectedNet = pipelined;
-            pipelined->connectedPorts.push_back(port);
+            port->Connect(index.GetNet(pipelined));
+            index.SetCellInput(cell, pin, pipelined);
+            MarkTimingDirty(index, cell);
+        }
+
+        void LogicDesign::DelayPin(NetlistIndex &index, CellId cell, int pin, int latency) {
+            NetId net = index.GetInput(cell, pin), pipelined = net;
+            while(index.netLatency[pipelined] < latency) {
+                pipelined = PipelineNet(index, pipelined);
+            }
+            if(pipelined != net) {
+                DeviceInputPort *port = index.GetCell(cell)->inputPorts[pin];
+                port->Disconnect();
+                port->Connect(index.GetNet(pipelined));
+                index.SetCellInput(cell, pin, pipelined);
+                MarkTimingDirty(index, cell);
+            }
+        }
+
+        void LogicDesign::DelayOutput(NetlistIndex &index, int port, int latency) {
+            NetId net = index.GetOutputPortNet(port), pipelined = net;
+            while(index.netLatency[pipelined] < latency) {
+                pipelined = PipelineNet(index, pipelined);
+            }
+            if(pipelined != net) {
+                outputPorts[port]->Disconnect();
+                outputPorts[port]->Connect(index.GetNet(pipelined));
+                index.SetOutputPortNet(port, pipelined);
+            }
         }
 
-        Bus* LogicDesign::ParseSignalDefinition(const vector<string> &splitLine, string prefix) {
+        Bus* LogicDesign::ParseSignalDefinition(const vector<Token> &splitLine, string prefix) {
             if(splitLine.size() < 4) {
                 PrintMessage(MSG_ERROR, "invalid signal definition");
             }
             string signalName = prefix + splitLine[1];
-            string signalType = splitLine[2];
-            int signalWidth = stoi(splitLine[3]);
+            string signalType = splitLine[2].str();
+            int signalWidth = stoi(splitLine[3].str());
             Bus *signalBus = new Bus();
             signalBus->name = signalName;
             signalBus->is_signed = (signalType == "SIGNED");
@@ -742,11 +1693,9 @@ namespace SynthFramework {
                 rangeEnd = stoi(rangeEndStr);
             }
             Bus *foundBus = nullptr;
-            for(auto bus : buses) {
-                if(bus->name == name) {
-                  foundBus = bus;
-                  break;
-                }
+            auto found = busesByName.find(name);
+            if(found != busesByName.end()) {
+                foundBus = found->second;
             }
             if(foundBus == nullptr) {
                 return nullptr;
@@ -755,12 +1704,12 @@ namespace SynthFramework {
                 rangeBus->is_signed = foundBus->is_signed;
                 rangeBus->width = (rangeEnd - rangeStart) + 1;
                 rangeBus->name = name;
+                rangeBus->signals.reserve(rangeBus->width);
                 for(int i = rangeStart; i <= rangeEnd; i++) {
                     if(i >= foundBus->signals.size()) {
                         PrintMessage(MSG_ERROR, "subrange out of bounds");
                     }
                     rangeBus->signals.push_back(foundBus->signals[i]);
-                    foundBus->signals[i]->parentBuses.push_back(rangeBus);
                 }
                 return rangeBus;
             } else {
@@ -768,21 +1717,67 @@ namespace SynthFramework {
             }
         }
 
-        void LogicDesign::AddBus(Bus *b) {
+        void LogicDesign::AddDevice(LogicDevice *dev) {
+            devices.push_back(dev);
+            if(mergeDuplicateDevices) {
+                LogicDevice *existing = structuralHash.FindEquivalent(dev);
+                if(existing != nullptr) {
+                    pendingDuplicates.push_back(make_pair(dev, existing));
+                } else {
+                    structuralHash.Insert(dev);
+                }
+            }
+        }
+
+        void LogicDesign::DestroyDevice(LogicDevice *dev) {
+            for(auto inp : dev->inputPorts) {
+                delete inp;
+            }
+            for(auto outp : dev->outputPorts) {
+                delete outp;
+            }
+            delete dev;
+        }
+
+        void LogicDesign::MergePendingDuplicates() {
+            for(auto dup : pendingDuplicates) {
+                LogicDevice *dev = dup.first, *existing = dup.second;
+                //Check the devices are still equivalent, in case their inputs were connected to other signals
+                if(dev->IsEquivalentTo(existing)) {
+                    for(int i = 0; i < dev->outputPorts.size(); i++) {
+                        Signal *oldNet = dev->outputPorts[i]->connectedNet;
+                        PrintMessage(MSG_DEBUG, "nets ===" + oldNet->name + "=== and ===" + existing->outputPorts[i]->connectedNet->name + "=== are driven by identical devices and will be merged");
+                        dev->outputPorts[i]->Disconnect();
+                        oldNet->ConnectTo(existing->outputPorts[i]->connectedNet);
+                    }
+                    dev->RemoveDevice();
+                    mergedDevices.insert(dev);
+                } else {
+                    structuralHash.Insert(dev);
+                }
+            }
+            pendingDuplicates.clear();
+        }
+
+        void LogicDesign::AddBus(Bus *b, string signalName) {
+            if(signalName == "") {
+                signalName = b->name;
+            }
             for(int i = 0; i < b->width; i++) {
                 Signal *sig;
                 if(b->width > 1) {
-                    sig = CreateSignal(b->name + "_bus_" + to_string(i));
+                    sig = CreateSignal(signalName + "_bus_" + to_string(i));
                 } else {
-                    sig = CreateSignal(b->name);
+                    sig = CreateSignal(signalName);
                 }
-                sig->parentBuses.push_back(b);
-                b->signals.push_back(sig);
+                b->AddSignal(sig);
             }
             buses.push_back(b);
+            busesByName.emplace(b->name, b);
         }
 
         Signal *LogicDesign::CreateSignal(string name) {
+            ArenaScope scope(&arena);
             Signal *sig = new Signal();
             sig->name = name;
             signals.push_back(sig);
@@ -790,6 +1785,7 @@ namespace SynthFramework {
         }
 
         Bus *LogicDesign::CreateConstantBus(int value) {
+            ArenaScope scope(&arena);
             Bus *cBus = new Bus();
             cBus->name = "cnst_" + to_string(value);
             cBus->is_signed = false;
@@ -852,7 +1848,7 @@ namespace SynthFramework {
 
             vhdl << "architecture polymer_synth of " << designName << " is" << endl;
             for(auto signal : signals) {
-                if((signal->connectedPorts.size() > 0) && (find(onebits.begin(), onebits.end(), signal) == onebits.end())) {
+                if(signal->IsConnected() && (find(onebits.begin(), onebits.end(), signal) == onebits.end())) {
                     vhdl << "\tsignal " << signal->name << " : std_logic;" << endl;
                 }
             }
@@ -892,6 +1888,675 @@ namespace SynthFramework {
             return vhdl.str();
         }
 
+        void LogicDesign::ApplyDeviceOption(const vector<string> &options) {
+            if(((options.size() == 3) && (options[1] == "TIMINGMODEL")) || ((options.size() == 4) && (options[1] == "CORNER"))) {
+                string cornerName = (options[1] == "CORNER") ? options[2] : technology->GetCornerName(0);
+                string filename = options.back();
+                if(technology->AddCorner(cornerName, filename))
+                    return;
+                for(auto dir : searchPath) {
+                    if(technology->AddCorner(cornerName, dir + "/" + filename))
+                        return;
+                }
+                PrintMessage(MSG_ERROR, "failed to open timing model " + filename);
+            } else {
+                technology->SetDeviceConstraint(options);
+            }
+        }
+
+        //Hash of the running executable. A different build may store netlists differently even if the format version
+        //wasn't changed, so its cache entries are never used
+        static uint64_t GetBuildHash() {
+            static const uint64_t buildHash = []() {
+                MappedFile exe;
+                if(!exe.Open("/proc/self/exe")) {
+                    return HashOffsetBasis;
+                }
+                return HashBytes(HashOffsetBasis, exe.GetData(), exe.GetSize());
+            }();
+            return buildHash;
+        }
+
+        string LogicDesign::GetCacheFilename() {
+            uint64_t key = HashBytes(contentHash, &BinaryNetlistVersion, sizeof(BinaryNetlistVersion));
+            uint64_t buildHash = GetBuildHash();
+            key = HashBytes(key, &buildHash, sizeof(buildHash));
+            stringstream name;
+            name << cacheDirectory << "/" << hex << setw(16) << setfill('0') << key << ".polybin";
+            return name.str();
+        }
+
+        bool LogicDesign::LoadFromCache(string filename) {
+            MappedFile file;
+            if(!file.Open(filename)) {
+                return false;
+            }
+            //The header is checked in full before anything is changed, so that a damaged entry is just ignored
+            BinaryReader in(file.GetData(), file.GetData() + file.GetSize());
+            int32_t phase;
+            if(!ReadBinaryNetlistHeader(in, phase) || (phase != DESIGN_SYNTHESISED)) {
+                PrintMessage(MSG_WARNING, "ignoring invalid cache entry " + filename);
+                return false;
+            }
+            ClearNetlist();
+            //The technology and constraints are already those the entry was created with, as they are part of the key
+            ReadSettings(in, false);
+            if(!ReadNetlist(in)) {
+                PrintMessage(MSG_ERROR, "failed to load cached netlist " + filename);
+            }
+            PrintMessage(MSG_NOTE, "loaded optimised design with " + to_string(devices.size()) + " devices from cache");
+            return true;
+        }
+
+        void LogicDesign::StoreInCache(string filename) {
+            //The directory is created if needed, but not its parents
+            mkdir(cacheDirectory.c_str(), 0777);
+            if(!SaveNetlist(filename, DESIGN_SYNTHESISED)) {
+                PrintMessage(MSG_WARNING, "failed to write cache entry " + filename);
+            }
+        }
+
+        bool LogicDesign::SaveNetlist(string filename, DesignPhase phase) {
+            BinaryWriter contents;
+            WriteSettings(contents);
+            WriteNetlist(contents, phase);
+            BinaryWriter out;
+            WriteBinaryNetlist(out, phase, contents);
+            return out.SaveToFile(filename);
+        }
+
+        bool LogicDesign::LoadNetlist(string filename, DesignPhase &phase) {
+            MappedFile file;
+            if(!file.Open(filename)) {
+                return false;
+            }
+            BinaryReader in(file.GetData(), file.GetData() + file.GetSize());
+            int32_t savedPhase;
+            if(!ReadBinaryNetlistHeader(in, savedPhase) || (savedPhase < DESIGN_LOADED) || (savedPhase > DESIGN_PIPELINED)) {
+                return false;
+            }
+            phase = DesignPhase(savedPhase);
+            ReadSettings(in, true);
+            return ReadNetlist(in);
+        }
+
+        vector<ExplorationPoint> LogicDesign::ExploreFrequencies(const vector<double> &frequencies) {
+            //Each copy is loaded from a snapshot of the design, sharing its technology like a submodule synthesised
+            //on its own, so the design is only read while the snapshot is taken
+            BinaryWriter snapshot;
+            WriteSettings(snapshot);
+            WriteNetlist(snapshot, DESIGN_SYNTHESISED);
+            vector<ExplorationPoint> points(frequencies.size());
+            //Messages from copies being pipelined at the same time would be interleaved, so only errors are printed
+            MessageLevel savedVerbosity = verbosity;
+            verbosity = MSG_ERROR;
+            atomic<int> next(0);
+            auto worker = [&]() {
+                int i;
+                while((i = next++) < int(frequencies.size())) {
+                    LogicDesign copy;
+                    copy.technology = technology;
+                    copy.sharedTechnology = true;
+                    BinaryReader in(snapshot.GetData().data(), snapshot.GetData().data() + snapshot.GetData().size());
+                    copy.ReadSettings(in, true);
+                    if(!copy.ReadNetlist(in)) {
+                        PrintMessage(MSG_ERROR, "failed to copy design");
+                    }
+                    copy.targetFrequency = frequencies[i];
+                    copy.PipelineDesign();
+                    copy.AnalysePostPipelineTiming();
+
+                    ExplorationPoint &point = points[i];
+                    point.frequency = frequencies[i];
+                    //Worst slack includes paths to the outputs, so that the frequency matches the timing report
+                    double period = 0;
+                    if(copy.worstSlack != numeric_limits<double>::infinity()) {
+                        period = (1.0 / frequencies[i]) - copy.worstSlack;
+                    }
+                    point.achievableFrequency = (period > 0) ? (1.0 / period) : numeric_limits<double>::infinity();
+                    point.latency = copy.pipelineLatency;
+                    for(auto dev : copy.devices) {
+                        if(dev->kind == DEVICE_LUT) {
+                            point.lutCount++;
+                        } else if(dev->kind == DEVICE_FLIPFLOP) {
+                            point.ffCount++;
+                        }
+                    }
+                }
+            };
+            //The copies are all pipelined on new threads, so that device names on this thread aren't affected
+            int threadCount = min<int>(max<int>(thread::hardware_concurrency(), 1), frequencies.size());
+            vector<thread> threads;
+            for(int i = 0; i < threadCount; i++) {
+                threads.push_back(thread(worker));
+            }
+            for(auto &t : threads) {
+                t.join();
+            }
+            verbosity = savedVerbosity;
+
+            //Of points with the same results, only the first is kept on the front
+            for(int i = 0; i < points.size(); i++) {
+                const ExplorationPoint &a = points[i];
+                points[i].pareto = true;
+                for(int j = 0; j < points.size(); j++) {
+                    const ExplorationPoint &b = points[j];
+                    bool asGood = (b.achievableFrequency >= a.achievableFrequency) && (b.latency <= a.latency)
+                            && (b.lutCount <= a.lutCount) && (b.ffCount <= a.ffCount);
+                    bool better = (b.achievableFrequency > a.achievableFrequency) || (b.latency < a.latency)
+                            || (b.lutCount < a.lutCount) || (b.ffCount < a.ffCount);
+                    if((j != i) && asGood && (better || (j < i))) {
+                        points[i].pareto = false;
+                        break;
+                    }
+                }
+            }
+            return points;
+        }
+
+        void LogicDesign::WriteSettings(BinaryWriter &out) {
+            out.WriteString(designName);
+            out.WriteString(targetName);
+            out.WriteInt(deviceOptions.size());
+            for(auto &options : deviceOptions) {
+                out.WriteInt(options.size());
+                for(auto &option : options) {
+                    out.WriteString(option);
+                }
+            }
+            out.WriteDouble(targetFrequency);
+            out.WriteDouble(timingSlack);
+            out.WriteDouble(timingBudget);
+            out.WriteBool(allowPipeline);
+            out.WriteBool(allowRetime);
+            out.WriteBool(minimiseRegisters);
+            out.WriteBool(allowShiftRegisters);
+            out.WriteInt(maxLatency);
+            out.WriteInt(minLatency);
+            out.WriteBool(hierarchical);
+            out.WriteBool(globalHasEnable);
+            out.WriteBool(globalHasReset);
+            out.WriteU64(contentHash);
+            out.WriteU64(technologyHash);
+        }
+
+        void LogicDesign::ReadSettings(BinaryReader &in, bool apply) {
+            string savedName = in.ReadString();
+            string savedTarget = in.ReadString();
+            vector<vector<string>> savedOptions(max(in.ReadInt(), 0));
+            for(auto &options : savedOptions) {
+                options.resize(max(in.ReadInt(), 0));
+                for(auto &option : options) {
+                    option = in.ReadString();
+                }
+            }
+            double savedFrequency = in.ReadDouble();
+            double savedSlack = in.ReadDouble();
+            double savedBudget = in.ReadDouble();
+            bool savedAllowPipeline = in.ReadBool();
+            bool savedAllowRetime = in.ReadBool();
+            bool savedMinimiseRegisters = in.ReadBool();
+            bool savedAllowShiftRegisters = in.ReadBool();
+            int savedMaxLatency = in.ReadInt();
+            int savedMinLatency = in.ReadInt();
+            bool savedHierarchical = in.ReadBool();
+            bool savedHasEnable = in.ReadBool();
+            bool savedHasReset = in.ReadBool();
+            uint64_t savedContentHash = in.ReadU64();
+            uint64_t savedTechnologyHash = in.ReadU64();
+            if(!apply || !in.IsValid())
+                return;
+            designName = savedName;
+            targetName = savedTarget;
+            if((targetName != "") && !sharedTechnology) {
+                technology = CreateTechnology(targetName);
+                if(technology == nullptr) {
+                    PrintMessage(MSG_ERROR, "Target " + targetName + " not supported");
+                }
+                for(auto &options : savedOptions) {
+                    ApplyDeviceOption(options);
+                }
+            }
+            deviceOptions = savedOptions;
+            targetFrequency = savedFrequency;
+            timingSlack = savedSlack;
+            timingBudget = savedBudget;
+            allowPipeline = savedAllowPipeline;
+            allowRetime = savedAllowRetime;
+            minimiseRegisters = savedMinimiseRegisters;
+            allowShiftRegisters = savedAllowShiftRegisters;
+            maxLatency = savedMaxLatency;
+            minLatency = savedMinLatency;
+            hierarchical = savedHierarchical;
+            globalHasEnable = savedHasEnable;
+            globalHasReset = savedHasReset;
+            contentHash = savedContentHash;
+            technologyHash = savedTechnologyHash;
+        }
+
+        void LogicDesign::WriteNetlist(BinaryWriter &out, DesignPhase phase) {
+            bool withOperations = (phase == DESIGN_LOADED);
+            vector<Bus*> savedBuses;
+            unordered_map<Bus*, int32_t> busIds;
+            auto AddBus = [&](Bus *bus) {
+                if(busIds.find(bus) == busIds.end()) {
+                    busIds[bus] = savedBuses.size();
+                    savedBuses.push_back(bus);
+                }
+            };
+            if(withOperations) {
+                for(auto bus : buses) {
+                    AddBus(bus);
+                }
+                //Slices used by operations aren't in the list of buses
+                for(auto oper : operations) {
+                    for(auto input : oper->inputs) {
+                        AddBus(input);
+                    }
+                    AddBus(oper->output);
+                }
+            }
+            for(auto iospec : io) {
+                AddBus(iospec->assocBus);
+            }
+            unordered_set<Bus*> registeredBuses(buses.begin(), buses.end());
+
+            //Nets are numbered from 3, with 0 meaning no net and 1 and 2 being the constants. Bus signals are saved
+            //as the signal they have been merged into, if any
+            unordered_map<Signal*, int32_t> netIds;
+            vector<Signal*> nets;
+            netIds[gnd] = 1;
+            netIds[vcc] = 2;
+            auto AddNet = [&](Signal *sig) {
+                if((sig != nullptr) && (netIds.find(sig) == netIds.end())) {
+                    netIds[sig] = nets.size() + 3;
+                    nets.push_back(sig);
+                }
+            };
+            auto GetNetId = [&](Signal *sig) -> int32_t {
+                return (sig != nullptr) ? netIds.at(sig->Resolve()) : 0;
+            };
+            auto GetPortNet = [&](LogicPort *port) -> int32_t {
+                return port->IsConnected() ? netIds.at(port->connectedNet) : 0;
+            };
+            unordered_set<Signal*> busSignals;
+            for(auto bus : savedBuses) {
+                for(auto sig : bus->signals) {
+                    busSignals.insert(sig->Resolve());
+                }
+            }
+            //Signals are kept in the same order so that the generated VHDL doesn't change
+            for(auto sig : signals) {
+                if(sig->IsConnected() || (busSignals.find(sig) != busSignals.end())) {
+                    AddNet(sig);
+                }
+            }
+            for(auto dev : devices) {
+                for(auto inp : dev->inputPorts) {
+                    if(inp->IsConnected()) {
+                        AddNet(inp->connectedNet);
+                    }
+                }
+                for(auto outp : dev->outputPorts) {
+                    if(outp->IsConnected()) {
+                        AddNet(outp->connectedNet);
+                    }
+                }
+            }
+            for(auto bus : savedBuses) {
+                for(auto sig : bus->signals) {
+                    AddNet(sig->Resolve());
+                }
+            }
+            AddNet(clockSignal);
+            AddNet(globalEnable);
+            AddNet(globalReset);
+
+            out.WriteInt(DEVICE_KIND_COUNT);
+            for(int i = 0; i < DEVICE_KIND_COUNT; i++) {
+                out.WriteInt(LogicDevice::createdCount[i]);
+            }
+
+            out.WriteInt(nets.size());
+            for(auto sig : nets) {
+                out.WriteString(sig->name);
+                out.WriteBool(sig->isSlow);
+                out.WriteBool(sig->avoidPipeline);
+                for(int c = 0; c < MaxTimingCorners; c++) {
+                    out.WriteDouble(sig->delay[c]);
+                }
+                out.WriteInt(sig->latency);
+            }
+
+            out.WriteInt(savedBuses.size());
+            for(auto bus : savedBuses) {
+                out.WriteString(bus->name);
+                out.WriteBool(bus->is_signed);
+                out.WriteInt(bus->width);
+                out.WriteBool(registeredBuses.find(bus) != registeredBuses.end());
+                out.WriteInt(bus->signals.size());
+                for(auto sig : bus->signals) {
+                    out.WriteInt(GetNetId(sig));
+                }
+            }
+
+            out.WriteInt(io.size());
+            for(auto iospec : io) {
+                out.WriteString(iospec->IOName);
+                out.WriteBool(iospec->is_output);
+                out.WriteBool(iospec->is_signed);
+                out.WriteInt(iospec->width);
+                out.WriteInt(busIds.at(iospec->assocBus));
+                out.WriteInt(iospec->assocPorts.size());
+                for(auto port : iospec->assocPorts) {
+                    out.WriteInt(GetPortNet(port));
+                }
+            }
+
+            unordered_map<LogicPort*, int32_t> portIndex;
+            for(int i = 0; i < inputPorts.size(); i++) {
+                portIndex[inputPorts[i]] = i;
+            }
+            for(int i = 0; i < outputPorts.size(); i++) {
+                portIndex[outputPorts[i]] = i;
+            }
+            out.WriteInt(latcons.size());
+            for(auto latcon : latcons) {
+                out.WriteInt(latcon->ext_latency);
+                out.WriteInt(latcon->outputs.size());
+                for(auto output : latcon->outputs) {
+                    out.WriteInt(portIndex.at(output));
+                }
+                out.WriteInt(latcon->inputs.size());
+                for(auto input : latcon->inputs) {
+                    out.WriteInt(portIndex.at(input));
+                }
+            }
+
+            out.WriteInt(GetNetId(clockSignal));
+            out.WriteInt(GetNetId(globalEnable));
+            out.WriteInt(GetNetId(globalReset));
+
+            out.WriteInt(withOperations ? operations.size() : 0);
+            if(withOperations) {
+                for(auto oper : operations) {
+                    out.WriteInt(oper->type);
+                    out.WriteString(oper->name);
+                    out.WriteInt(oper->inputs.size());
+                    for(auto input : oper->inputs) {
+                        out.WriteInt(busIds.at(input));
+                    }
+                    out.WriteInt(busIds.at(oper->output));
+                }
+            }
+
+            out.WriteInt(devices.size());
+            for(auto dev : devices) {
+                out.WriteInt(dev->kind);
+                out.WriteString(dev->name);
+                out.WriteBool(dev->pipelineDone);
+                dev->WriteConfig(out);
+                out.WriteInt(dev->inputPorts.size());
+                for(auto inp : dev->inputPorts) {
+                    out.WriteInt(inp->pin);
+                    out.WriteInt(GetPortNet(inp));
+                }
+                out.WriteInt(dev->outputPorts.size());
+                for(auto outp : dev->outputPorts) {
+                    out.WriteInt(outp->pin);
+                    out.WriteInt(GetPortNet(outp));
+                }
+            }
+        }
+
+        bool LogicDesign::ReadNetlist(BinaryReader &in) {
+            ArenaScope scope(&arena);
+            bool valid = true;
+            vector<int32_t> counts(max(in.ReadInt(), 0));
+            for(auto &count : counts) {
+                count = in.ReadInt();
+            }
+
+            int32_t netCount = in.ReadInt();
+            if(!in.IsValid() || (netCount < 0)) {
+                return false;
+            }
+            vector<Signal*> nets = {nullptr, gnd, vcc};
+            for(int i = 0; (i < netCount) && in.IsValid(); i++) {
+                Signal *sig = CreateSignal(in.ReadString());
+                sig->isSlow = in.ReadBool();
+                sig->avoidPipeline = in.ReadBool();
+                for(int c = 0; c < MaxTimingCorners; c++) {
+                    sig->delay[c] = in.ReadDouble();
+                }
+                sig->latency = in.ReadInt();
+                nets.push_back(sig);
+            }
+            auto GetNet = [&](int32_t id) -> Signal* {
+                if((id < 0) || (id >= nets.size())) {
+                    valid = false;
+                    return nullptr;
+                }
+                return nets[id];
+            };
+
+            int32_t busCount = in.ReadInt();
+            vector<Bus*> savedBuses;
+            for(int i = 0; (i < busCount) && in.IsValid() && valid; i++) {
+                Bus *bus = new Bus();
+                bus->name = in.ReadString();
+                bus->is_signed = in.ReadBool();
+                int32_t width = in.ReadInt();
+                bool registered = in.ReadBool();
+                int32_t signalCount = in.ReadInt();
+                for(int j = 0; (j < signalCount) && in.IsValid(); j++) {
+                    Signal *sig = GetNet(in.ReadInt());
+                    if(sig == nullptr) {
+                        valid = false;
+                        break;
+                    }
+                    //Slices are not recorded in the parentBuses of their signals
+                    if(registered) {
+                        bus->AddSignal(sig);
+                    } else {
+                        bus->signals.push_back(sig);
+                    }
+                }
+                bus->width = width;
+                if(registered) {
+                    buses.push_back(bus);
+                    busesByName.emplace(bus->name, bus);
+                }
+                savedBuses.push_back(bus);
+            }
+            auto GetBus = [&](int32_t id) -> Bus* {
+                if((id < 0) || (id >= savedBuses.size())) {
+                    valid = false;
+                    return nullptr;
+                }
+                return savedBuses[id];
+            };
+
+            int32_t ioCount = in.ReadInt();
+            for(int i = 0; (i < ioCount) && in.IsValid() && valid; i++) {
+                DesignIO *iospec = new DesignIO();
+                iospec->IOName = in.ReadString();
+                iospec->is_output = in.ReadBool();
+                iospec->is_signed = in.ReadBool();
+                iospec->width = in.ReadInt();
+                iospec->assocBus = GetBus(in.ReadInt());
+                int32_t portCount = in.ReadInt();
+                if((iospec->assocBus == nullptr) || (portCount > iospec->assocBus->signals.size())) {
+                    return false;
+                }
+                for(int j = 0; (j < portCount) && in.IsValid(); j++) {
+                    Signal *net = GetNet(in.ReadInt());
+                    LogicPort *port;
+                    if(iospec->is_output) {
+                        DesignOutputPort *dop = new DesignOutputPort();
+                        dop->design = this;
+                        dop->linkedIO = iospec;
+                        dop->busIndex = j;
+                        outputPorts.push_back(dop);
+                        port = dop;
+                    } else {
+                        DesignInputPort *dip = new DesignInputPort();
+                        dip->design = this;
+                        dip->linkedIO = iospec;
+                        dip->busIndex = j;
+                        inputPorts.push_back(dip);
+                        port = dip;
+                    }
+                    if(net != nullptr) {
+                        port->Connect(net);
+                    } else {
+                        //Ports that were disconnected, such as submodule inputs tied to a constant
+                        port->connectedNet = iospec->assocBus->signals[j];
+                    }
+                    iospec->assocPorts.push_back(port);
+                }
+                io.push_back(iospec);
+            }
+
+            int32_t latconCount = in.ReadInt();
+            for(int i = 0; (i < latconCount) && in.IsValid() && valid; i++) {
+                LatencyConstraint *latcon = new LatencyConstraint();
+                latcon->ext_latency = in.ReadInt();
+                int32_t outputCount = in.ReadInt();
+                for(int j = 0; (j < outputCount) && in.IsValid(); j++) {
+                    int32_t index = in.ReadInt();
+                    if((index < 0) || (index >= outputPorts.size())) {
+                        return false;
+                    }
+                    outputPorts[index]->latcons.push_back(latcon);
+                    latcon->outputs.push_back(outputPorts[index]);
+                }
+                int32_t inputCount = in.ReadInt();
+                for(int j = 0; (j < inputCount) && in.IsValid(); j++) {
+                    int32_t index = in.ReadInt();
+                    if((index < 0) || (index >= inputPorts.size())) {
+                        return false;
+                    }
+                    inputPorts[index]->latcon = latcon;
+                    latcon->inputs.push_back(inputPorts[index]);
+                }
+                latcons.push_back(latcon);
+            }
+
+            clockSignal = GetNet(in.ReadInt());
+            globalEnable = GetNet(in.ReadInt());
+            globalReset = GetNet(in.ReadInt());
+
+            int32_t operationCount = in.ReadInt();
+            for(int i = 0; (i < operationCount) && in.IsValid() && valid; i++) {
+                int32_t type = in.ReadInt();
+                if(OperationInfo.find(OperationType(type)) == OperationInfo.end()) {
+                    return false;
+                }
+                Operation *oper = new Operation();
+                oper->type = OperationType(type);
+                oper->name = in.ReadString();
+                int32_t inputCount = in.ReadInt();
+                for(int j = 0; (j < inputCount) && in.IsValid(); j++) {
+                    oper->inputs.push_back(GetBus(in.ReadInt()));
+                }
+                oper->output = GetBus(in.ReadInt());
+                operations.push_back(oper);
+            }
+
+            int32_t deviceCount = in.ReadInt();
+            for(int i = 0; (i < deviceCount) && in.IsValid() && valid; i++) {
+                int32_t kind = in.ReadInt();
+                LogicDevice *dev = nullptr;
+                if((kind >= 0) && (kind < DEVICE_KIND_COUNT)) {
+                    dev = CreateDeviceOfKind(DeviceKind(kind));
+                }
+                if(dev == nullptr) {
+                    return false;
+                }
+                dev->name = in.ReadString();
+                dev->pipelineDone = in.ReadBool();
+                //Configuration is read first, as constant devices must know their value before being connected
+                dev->ReadConfig(in);
+                int32_t inputCount = in.ReadInt();
+                for(int j = 0; (j < inputCount) && in.IsValid(); j++) {
+                    DeviceInputPort *port = new DeviceInputPort();
+                    port->device = dev;
+                    port->pin = in.ReadInt();
+                    Signal *net = GetNet(in.ReadInt());
+                    if(net != nullptr) {
+                        port->Connect(net);
+                    }
+                    dev->inputPorts.push_back(port);
+                }
+                int32_t outputCount = in.ReadInt();
+                for(int j = 0; (j < outputCount) && in.IsValid(); j++) {
+                    DeviceOutputPort *port = new DeviceOutputPort();
+                    port->device = dev;
+                    port->pin = in.ReadInt();
+                    Signal *net = GetNet(in.ReadInt());
+                    if(net != nullptr) {
+                        port->Connect(net);
+                    }
+                    dev->outputPorts.push_back(port);
+                }
+                AddDevice(dev);
+            }
+
+            //Devices created from now on must not reuse the names of those loaded
+            for(int i = 0; (i < counts.size()) && (i < DEVICE_KIND_COUNT); i++) {
+                LogicDevice::createdCount[i] = max(LogicDevice::createdCount[i], counts[i]);
+            }
+            return valid && in.IsValid();
+        }
+
+        void LogicDesign::ClearNetlist() {
+            ArenaScope scope(&arena);
+            for(auto dev : devices) {
+                dev->RemoveDevice();
+                DestroyDevice(dev);
+            }
+            for(auto inp : inputPorts) {
+                inp->Disconnect();
+                delete inp;
+            }
+            for(auto outp : outputPorts) {
+                outp->Disconnect();
+                delete outp;
+            }
+            for(auto iospec : io) {
+                delete iospec;
+            }
+            for(auto latcon : latcons) {
+                delete latcon;
+            }
+            for(auto oper : operations) {
+                delete oper;
+            }
+            for(auto bus : buses) {
+                delete bus;
+            }
+            for(auto sig : signals) {
+                delete sig;
+            }
+            devices.clear();
+            inputPorts.clear();
+            outputPorts.clear();
+            io.clear();
+            latcons.clear();
+            operations.clear();
+            buses.clear();
+            signals.clear();
+            busesByName.clear();
+            structuralHash.Clear();
+            //Constants may have been merged with signals of buses that no longer exist
+            gnd->parentBuses.clear();
+            vcc->parentBuses.clear();
+            clockSignal = nullptr;
+            globalEnable = nullptr;
+            globalReset = nullptr;
+        }
+
         bool DesignInputPort::IsDriver() {
             return true;
         }
@@ -3,12 +3,21 @@
 #include <string>
 #include <map>
 #include <set>
+#include <unordered_set>
+#include <unordered_map>
+#include <memory>
 #include "BasicDevices.hpp"
 #include "LogicCore.hpp"
 #include "LogicPort.hpp"
 #include "Signal.hpp"
 #include "DeviceTechnology.hpp"
 #include "Operations.hpp"
+#include "StructuralHash.hpp"
+#include "NetlistIndex.hpp"
+#include "Arena.hpp"
+#include "NetlistReader.hpp"
+#include "SubmoduleCache.hpp"
+#include "BinaryNetlist.hpp"
 using namespace std;
 
 namespace SynthFramework {
@@ -16,7 +25,7 @@ namespace SynthFramework {
 
     class LogicDesign;
     //Describes a top level input/output, which may be a bus
-    struct DesignIO {
+    struct DesignIO : public ArenaObject {
       string IOName;
       bool is_output = false;
       int width = 0;
@@ -56,16 +65,34 @@ namespace SynthFramework {
 
     //A latency constraint forces the latency of some inputs to be related to the latency some outputs
     //This is used when there are external ROMs, etc
-    class LatencyConstraint {
+    class LatencyConstraint : public ArenaObject {
     public:
       vector<DesignOutputPort*> outputs;
       vector<DesignInputPort*> inputs;
       int ext_latency = 1;
     };
 
+    //Points in the flow at which a design can be saved as a binary netlist, and later resumed
+    enum DesignPhase {
+      DESIGN_LOADED, //loaded, but not synthesised
+      DESIGN_SYNTHESISED, //synthesised and optimised
+      DESIGN_PIPELINED //pipeline registers inserted
+    };
+
+    //Result of pipelining a design for one target frequency while exploring the frequencies it can be pipelined for
+    struct ExplorationPoint {
+      double frequency = 0; //target frequency pipelined for
+      double achievableFrequency = 0; //highest frequency the pipelined design meets timing at
+      int latency = 0;
+      int lutCount = 0, ffCount = 0;
+      bool pareto = false; //set if no other point is as good in every respect and better in one
+    };
+
     class LogicDesign {
     public:
       LogicDesign();
+      //Destroys the entire design
+      ~LogicDesign();
 
       string designName = "";
       vector<DesignIO*> io;
@@ -76,55 +103,209 @@ namespace SynthFramework {
       vector<Bus*> buses; //all buses in the design
       vector<Signal*> signals; //all signals in the design
       vector<LatencyConstraint*> latcons;
-      DeviceTechnology* technology;
+      DeviceTechnology* technology = nullptr;
 
       //Search path for submodules (searched in order)
       vector<string> searchPath;
+      //If set, each distinct submodule is synthesised and optimised once, and the result copied for each instance,
+      //instead of every instance being flattened into the design before synthesis (OPTION HIERARCHY ON)
+      bool hierarchical = false;
+      //Directory optimised netlists are cached in, so that unchanged designs need not be synthesised again. Caching is
+      //disabled if empty
+      string cacheDirectory = "";
+      //Number of threads used to analyse each level of a large design during timing analysis, 0 to use all hardware
+      //threads
+      int timingThreads = 1;
+      //Number of worst paths to report after pipelining, and the file to write them to. The report is printed if no
+      //file is given
+      int timingReportPaths = 0;
+      string timingReportFile = "";
 
       //Build the LogicDesign from input data (some kind of intermediate language optionally output by ElasticC)
       //This populates io, inputPorts, outputPorts, operations, buses and signals but does not generate any LUTs
       //or other low-level devices
       //prefix is set if including a submodule instead of loading the top level design
       //portmap is a map between submodule IO names and top level buses if in a submodule
-      void LoadDesign(string data, string prefix = "", const map<string, Bus*> &portmap = map<string, Bus*>());
+      void LoadDesign(const string &data, string prefix = "", const map<string, Bus*> &portmap = map<string, Bus*>());
+      void LoadDesign(const char *begin, const char *end, string prefix = "", const map<string, Bus*> &portmap = map<string, Bus*>());
+      //Load the design from a file, which is memory mapped rather than read into a string. Returns false if the file
+      //could not be opened
+      bool LoadDesignFile(string filename, string prefix = "", const map<string, Bus*> &portmap = map<string, Bus*>());
       //Perform optimisations on the design and synthesise it to LUTs, etc of the correct size and type for the FPGA
       void SynthesiseAndOptimiseDesign();
       //Run timing analysis on the design
       void AnalyseTiming();
-      //Insert pipeline registers as necessary
+      //Analyse timing and insert pipeline registers as necessary
       void PipelineDesign();
       //Run a post-pipeline timing analysis
       void AnalysePostPipelineTiming();
       //Convert the design to a VHDL netlist
       string GenerateVHDL();
+      //Save the design as a binary netlist, recording the phase it has reached. Returns false if the file could not be
+      //written
+      bool SaveNetlist(string filename, DesignPhase phase);
+      //Load a design saved with SaveNetlist into a new LogicDesign, setting the phase it was saved at. The technology
+      //and constraints are restored along with the netlist. Returns false if the file could not be read or is invalid
+      bool LoadNetlist(string filename, DesignPhase &phase);
+      //Pipeline copies of the synthesised design for each of a set of target frequencies, in parallel, and return the
+      //result for each frequency. The design itself is left unchanged
+      vector<ExplorationPoint> ExploreFrequencies(const vector<double> &frequencies);
 
       //Design constraints
       double targetFrequency = 50e6; //design target frequency in Hz
       double timingSlack = 0; //slack to subtract from clock period in seconds
       double timingBudget = 0.9; //fraction of clock period after which signals should be valid
       bool allowPipeline = true;
+      //If set, pipeline registers are moved across LUTs after pipelining to reduce their number (OPTION RETIME ON)
+      bool allowRetime = false;
+      //If set, the latencies found by pipelining are reassigned to use as few registers as possible, which may change
+      //the latency of the outputs (OPTION PIPELINE MINREG)
+      bool minimiseRegisters = false;
+      //If set, chains of registers left after pipelining are replaced by the shift register resources of the technology
+      //(OPTION SHIFTREG OFF to disable)
+      bool allowShiftRegisters = true;
       int maxLatency = -1; //max pipeline latency, -1 = unlimited
       int minLatency = 0; //min pipeline latency
 
+      //Results of pipelining, set by PipelineDesign and AnalysePostPipelineTiming
+      int pipelineLatency = 0;
+      double worstSlack = 0; //worst setup slack in seconds, infinite if there are no registered inputs or outputs
+
       //Special purpose signals
       Signal* gnd, *vcc;
 
+      //Table used to find equivalent devices during synthesis and optimisation
+      StructuralHash structuralHash;
+
       //Miscellaneous helper functions
-      void AddBus(Bus *b);
+      //Add a device to the design. During synthesis, devices equivalent to an existing device are merged into it once
+      //the operation being synthesised is complete
+      void AddDevice(LogicDevice *dev);
+      //Free a device that has been removed from the design, along with its ports
+      void DestroyDevice(LogicDevice *dev);
+      //Add a bus to the design, creating its signals. Signal names are based on signalName if given, otherwise the bus name
+      void AddBus(Bus *b, string signalName = "");
       Signal *CreateSignal(string name);
       Bus *CreateConstantBus(int value); //Create a bus with a fixed value (for now value must be positive)
       //Global pipeline controls
       bool globalHasEnable = false, globalHasReset = false;
       Signal *clockSignal = nullptr, *globalEnable = nullptr, *globalReset = nullptr;
     private:
-      Bus* ParseSignalDefinition(const vector<string> &splitLine, string prefix); //Parse any signal definition - input, output or internal signal
+      friend class Retimer;
+      //All signals, buses, ports, devices, etc belonging to the design are allocated from the arena
+      Arena arena;
+      ConstantDevice *gndDriver, *vccDriver;
+      bool sharedTechnology = false; //set if technology belongs to the design including this one, so isn't deleted with it
+
+      //Hash of everything loaded into the design, and so everything the result of synthesis depends on, used as the
+      //key for the synthesis cache
+      uint64_t contentHash = HashOffsetBasis;
+      //Hash of the statements setting up the technology, which submodules synthesised on their own depend on too
+      uint64_t technologyHash = HashOffsetBasis;
+      //Return the file the optimised netlist of the design is cached in
+      string GetCacheFilename();
+      //Replace the design with a cached netlist, returning false if there is no valid cache entry
+      bool LoadFromCache(string filename);
+      void StoreInCache(string filename);
+      //Statements used to set up the technology, kept so that it can be recreated when a binary netlist is loaded
+      string targetName = "";
+      vector<vector<string>> deviceOptions;
+      //Apply a DEVOPT statement to the technology. DEVOPT TIMINGMODEL file loads a timing model, and DEVOPT CORNER
+      //name file adds a delay corner with its own timing model. Timing model files are looked for in the search path,
+      //and anything else is passed on to the technology
+      void ApplyDeviceOption(const vector<string> &options);
+      //Save or restore the technology and constraints. If apply is false, they are read but the current ones are kept
+      void WriteSettings(BinaryWriter &out);
+      void ReadSettings(BinaryReader &in, bool apply);
+      //Save or restore the netlist. Operations, and buses other than those of the IO, are only needed before synthesis
+      void WriteNetlist(BinaryWriter &out, DesignPhase phase);
+      bool ReadNetlist(BinaryReader &in);
+      //Remove the IO, signals, operations and devices of the design, leaving its constraints and technology
+      void ClearNetlist();
+
+      //Submodules included by the design being loaded
+      SubmoduleCache submodules;
+      //Load a single non-empty line of a netlist. lno is the line number, counting only non-empty lines
+      void LoadStatement(const vector<Token> &splitLine, int lno, const string &prefix, const map<string, Bus*> &portmap);
+      //Load the contents of a parsed submodule into the design
+      void InstantiateSubmodule(const ParsedNetlist *module, string prefix, const map<string, Bus*> &portmap);
+
+      //A submodule synthesised on its own in hierarchical mode, which is copied into the design for each instance
+      struct SubmoduleImplementation {
+        unique_ptr<LogicDesign> design;
+        //Ports of the submodule, in the order of the bits of its inputs and outputs. Inputs tied to a constant are nullptr
+        vector<DesignInputPort*> inputs;
+        vector<DesignOutputPort*> outputs;
+        Signal *implicitClock = nullptr; //clock used by the submodule if it has no clock input
+      };
+      //Implementations of submodules, keyed on the submodule and the constant value of each of its input bits
+      map<pair<const ParsedNetlist*, string>, unique_ptr<SubmoduleImplementation>> submoduleImplementations;
+      //Add an instance of a submodule in hierarchical mode, copying the devices of its implementation into the design
+      void InstantiateHierarchical(const ParsedNetlist *module, string moduleName, string prefix, const map<string, Bus*> &portmap);
+      //Find the implementation of a submodule for a given set of constant inputs, synthesising it if not done already
+      //The signature has a character for each input bit, '0' or '1' if the bit is constant and 'x' otherwise
+      SubmoduleImplementation *GetSubmoduleImplementation(const ParsedNetlist *module, string moduleName, const string &signature);
+      Bus* ParseSignalDefinition(const vector<Token> &splitLine, string prefix); //Parse any signal definition - input, output or internal signal
+      //Find a bus by name, or create a slice of a bus if a range such as A[7:0] is given
+      //Slices are not added to the parentBuses of their signals, so must have Bus::ResolveSignals called before use if
+      //any signals may have been merged since they were created
       Bus* FindBusByName(string name);
-      //Setting stopAtRegister to true improves performance by only considering timing upto the first register
-      //The set is used to avoid analysing devices more than once thus improving performance
-      void AnalyseTimingRecursive(LogicDevice* target, bool stopAtRegister, set<LogicDevice*> &analysed);
-      void PipelineDesignRecursive(LogicDevice* target);
+      unordered_map<string, Bus*> busesByName; //the first bus added with each name
+      //Compute the delay of every net in the design, evaluating cells a level at a time in a single forward pass
+      void AnalyseTimingLevelized(NetlistIndex &index, const vector<CellId> &order, const vector<uint32_t> &levelStart);
+      //Find the delay from an input of a cell to an output at a corner, returning false if the output doesn't depend on it
+      bool GetCellTimingArc(NetlistIndex &index, CellId cell, int input, int output, int corner, double &routingDelay, double &cellDelay);
+      //Propagate required times back from the nets whose required time has been set, in a single backward pass over
+      //the cells in the order given by NetlistIndex::Levelize
+      void PropagateRequiredTimes(NetlistIndex &index, const vector<CellId> &order);
+      //Describe the path with the greatest delay to a net at an endpoint at a corner, with the delay of each stage
+      //along it
+      string ReportCriticalPath(NetlistIndex &index, NetId endNet, const string &endpoint, int corner);
+      //Compute the delay of the outputs of a cell from the delays of its inputs
+      void EvaluateCellTiming(NetlistIndex &index, CellId cell);
+      //Timing is updated incrementally during pipelining. Compute the delay of the outputs of a cell, first updating
+      //any cells driving it whose timing is out of date
+      void AnalyseConeTiming(NetlistIndex &index, CellId target);
+      //Mark the timing of a cell whose inputs have changed as out of date, along with the cells it drives up to the
+      //next registers
+      void MarkTimingDirty(NetlistIndex &index, CellId cell);
+      //Frequency the pipeliner aims for, which differs from targetFrequency while searching for a pipeline that meets
+      //the latency limits
+      double pipelineFrequency = 50e6;
+      //Groups of latency constraints, as indices into latcons, in the order they are solved by the pipeliner
+      vector<vector<int>> latconGroups;
+      //Find latconGroups. Constraints sharing an output are grouped together, as their outputs have the same latency,
+      //and each group is solved after the groups whose inputs its outputs depend on. Groups depending on each other
+      //in a cycle are reported, and solved in the order they were declared
+      void OrderLatencyConstraints();
+      //Number of steps taken by each search for a frequency meeting a latency limit
+      static const int LatencySearchSteps = 10;
+      //Insert pipeline registers to meet the timing budget at a frequency, balancing the latency of the outputs, and
+      //return the latency. A frequency of 0 gives no timing budget
+      int PipelineAtFrequency(double frequency);
+      //Replace the netlist with one saved by WriteNetlist, ready to be pipelined again
+      void RestoreNetlist(const BinaryWriter &snapshot);
+      //Delay a net may reach at a corner before it must be pipelined
+      double GetPipelineBudget(int corner);
+      //Replace chains of registers with shift registers, where the technology finds it worthwhile
+      void InferShiftRegisters();
+      //The pipeliner walks the netlist through an index, kept up to date alongside the object graph as it adds
+      //registers
+      void PipelineDesignRecursive(NetlistIndex &index, CellId target);
       Signal* PipelineSignal(Signal* source);
-      void PipelinePin(DeviceInputPort *pin); //shortcut to add a pipeline before a pin
+      //Equivalent of PipelineSignal for a net in the pipeliner's index
+      NetId PipelineNet(NetlistIndex &index, NetId net);
+      void PipelinePin(NetlistIndex &index, CellId cell, int pin); //shortcut to add a pipeline before a pin
+      //Add pipeline registers before a pin until its latency is at least the given latency, only reconnecting the pin
+      //once at the end
+      void DelayPin(NetlistIndex &index, CellId cell, int pin, int latency);
+      //Add pipeline registers after a top level output until its latency is at least the given latency
+      void DelayOutput(NetlistIndex &index, int port, int latency);
+
+      bool mergeDuplicateDevices = false; //set while operations are being synthesised
+      vector<pair<LogicDevice*, LogicDevice*>> pendingDuplicates; //devices found equivalent during synthesis, and the device they are equivalent to
+      unordered_set<LogicDevice*> mergedDevices; //devices removed during synthesis as they were duplicates
+      void MergePendingDuplicates();
 
     };
   }
@@ -22,16 +22,11 @@ namespace SynthFramework {
         }
 
         bool DeviceOutputPort::IsConstantDriver() {
-            ConstantDevice *cdev = dynamic_cast<ConstantDevice*>(device);
-            if(cdev != nullptr) {
-                return true;
-            } else {
-                return false;
-            }
+            return device->kind == DEVICE_CONSTANT;
         }
 
         LogicState DeviceOutputPort::GetConstantState() {
-            ConstantDevice *cdev = dynamic_cast<ConstantDevice*>(device);
+            ConstantDevice *cdev = DeviceCast<ConstantDevice>(device);
             if(cdev != nullptr) {
                 if(cdev->value) {
                     return LogicState_High;
@@ -43,6 +38,41 @@ namespace SynthFramework {
             }
         }
 
+        LogicDevice::LogicDevice(DeviceKind _kind) : kind(_kind) {
+
+        }
+
+        VendorSpecificDevice::VendorSpecificDevice(DeviceKind _kind) : LogicDevice(_kind) {
+
+        }
+
+        bool VendorSpecificDevice::IsRegisteredInput(int input) {
+            return false;
+        }
+
+        LogicDevice *LogicDevice::Clone() {
+            return nullptr;
+        }
+
+        void LogicDevice::WriteConfig(BinaryWriter &out) {
+
+        }
+
+        void LogicDevice::ReadConfig(BinaryReader &in) {
+
+        }
+
+        thread_local int LogicDevice::createdCount[DEVICE_KIND_COUNT];
+
+        void LogicDevice::ClearCloneState() {
+            inputPorts.clear();
+            outputPorts.clear();
+            pipelineDone = false;
+            optimiseIndex = -1;
+            structuralHash = 0;
+            inStructuralHash = false;
+        }
+
         void LogicDevice::RemoveDevice() {
             for(auto inp : inputPorts) {
                 inp->Disconnect();
@@ -60,5 +90,9 @@ namespace SynthFramework {
             return false;
         }
 
+        bool LogicDevice::GetStructuralHash(size_t &hash) {
+            return false;
+        }
+
     }
 }
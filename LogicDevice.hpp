@@ -15,6 +15,26 @@ namespace SynthFramework {
     */
     class LogicDevice;
     class LogicDesign;
+    class BinaryWriter;
+    class BinaryReader;
+
+    //Type tag of a device, so that devices can be classified without using RTTI
+    //Vendor specific devices must come after DEVICE_VENDOR_FIRST
+    enum DeviceKind {
+      DEVICE_OTHER,
+      DEVICE_LUT,
+      DEVICE_FLIPFLOP,
+      DEVICE_CONSTANT,
+      DEVICE_VENDOR_FIRST,
+      DEVICE_XILINX_CARRY4 = DEVICE_VENDOR_FIRST,
+      DEVICE_XILINX_DSP48MUL,
+      DEVICE_ALTERA_CARRYSUM,
+      DEVICE_ALTERA_ROM,
+      DEVICE_ALTERA_MULTIPLIER18,
+      DEVICE_XILINX_SRL,
+      DEVICE_ALTERA_SHIFTTAPS,
+      DEVICE_KIND_COUNT //number of kinds, not itself a kind
+    };
 
     class DeviceInputPort : public LogicPort {
     public:
@@ -36,10 +56,14 @@ namespace SynthFramework {
       LogicState GetConstantState();
     };
 
-    class LogicDevice {
+    class LogicDevice : public ArenaObject {
     public:
+      LogicDevice(DeviceKind _kind = DEVICE_OTHER);
+      const DeviceKind kind;
+      static bool IsKind(DeviceKind) { return true; };
       string name;
       bool pipelineDone = false;
+      int optimiseIndex = -1; //Position of the device while the design is being optimised, -1 otherwise
       vector<DeviceInputPort*> inputPorts;
       vector<DeviceOutputPort*> outputPorts;
       //Disconnect all I/Os from the device, removing it from the system
@@ -49,12 +73,44 @@ namespace SynthFramework {
       virtual bool OptimiseDevice(LogicDesign *topLevel);
       //Returns true if two devices are equivalent
       virtual bool IsEquivalentTo(LogicDevice* other);
+      //Compute a hash of the device kind, configuration and input nets, such that equivalent devices have equal hashes
+      //Returns false if the device is never equivalent to another device
+      virtual bool GetStructuralHash(size_t &hash);
+      //Create an unconnected copy of the device with the same configuration, or return nullptr if not supported
+      virtual LogicDevice *Clone();
+      //Save or restore the configuration of the device, but not its connections, in a binary netlist
+      virtual void WriteConfig(BinaryWriter &out);
+      virtual void ReadConfig(BinaryReader &in);
+
+      //Key the device was stored under in the design's structural hash table, if it is in the table
+      size_t structuralHash = 0;
+      bool inStructuralHash = false;
 
+      //Number of devices of each kind created so far, used to give devices unique names. Kept for each thread, so
+      //that designs can be worked on in parallel
+      static thread_local int createdCount[DEVICE_KIND_COUNT];
+    protected:
+      //Reset the ports and per-design state of a device created with the copy constructor
+      void ClearCloneState();
     };
 
     //Indicates vendor-specific hardware blocks
     class VendorSpecificDevice : public LogicDevice {
-
+    public:
+      VendorSpecificDevice(DeviceKind _kind);
+      static bool IsKind(DeviceKind k) { return k >= DEVICE_VENDOR_FIRST; };
+      //Returns true if an input is captured by a register inside the device, so ends a timing path like the D input
+      //of a flip flop
+      virtual bool IsRegisteredInput(int input);
     };
+
+    //Cast a device to a given device class, returning nullptr if it is not of that class
+    template<typename T> T *DeviceCast(LogicDevice *dev) {
+      if((dev != nullptr) && T::IsKind(dev->kind)) {
+        return static_cast<T*>(dev);
+      } else {
+        return nullptr;
+      }
+    }
   }
 }
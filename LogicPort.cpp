@@ -4,16 +4,25 @@ using namespace std;
 
 namespace SynthFramework {
     namespace Polymer {
+        void LogicPort::Connect(Signal *net) {
+            connectedNet = net;
+            net->AddPort(this);
+        }
+
         void LogicPort::Disconnect() {
-            int index = -1;
-            for(int i = 0; i < connectedNet->connectedPorts.size(); i++) {
-                if(connectedNet->connectedPorts[i] == this) {
-                    index = i;
-                }
+            connectedNet->RemovePort(this);
+            connectedNet.Detach();
+        }
+
+        bool LogicPort::IsConnected() {
+            if(connectedNet == nullptr) {
+                return false;
             }
-            if(index != -1) {
-                connectedNet->connectedPorts.erase(connectedNet->connectedPorts.begin() + index);
+            if(connectedNet->driver == this) {
+                return true;
             }
+            const vector<LogicPort*> &list = IsDriver() ? connectedNet->extraDrivers : connectedNet->fanout;
+            return (netSlot >= 0) && (netSlot < list.size()) && (list[netSlot] == this);
         }
     }
 }
@@ -8,14 +8,43 @@ using namespace std;
 
 namespace SynthFramework {
   namespace Polymer {
+     /*The net a port is connected to, which is looked up through Signal::Resolve when used, so that merging nets
+     doesn't need to visit every port connected to them*/
+     class NetRef {
+     public:
+       NetRef(Signal *_net = nullptr) : net(_net) {};
+       Signal *Get() const {
+         if(!detached && (net != nullptr) && net->IsMerged()) {
+           net = net->Resolve();
+         }
+         return net;
+       };
+       operator Signal*() const { return Get(); };
+       Signal *operator->() const { return Get(); };
+       //Stop following merges, so that a disconnected port keeps the net it was last connected to
+       void Detach() {
+         Get();
+         detached = true;
+       };
+     private:
+       mutable Signal *net;
+       bool detached = false;
+     };
+
      /*A generic multi-input, one-output LUT, used before a technology-specific LUT is instantiated*/
-     class LogicPort {
+     class LogicPort : public ArenaObject {
      public:
-       Signal *connectedNet;
+       NetRef connectedNet;
+       int netSlot = -1; //Position of the port in its net's fanout or extraDrivers, -1 if it is the main driver or disconnected
        virtual bool IsDriver() = 0; //Is driving net?
        virtual bool IsConstantDriver() = 0; //Is driving net at a constant value
        virtual LogicState GetConstantState() = 0; //If constant value, return value of driver
+       //Connect the port to a net
+       void Connect(Signal *net);
+       //Remove the port from the net it is connected to. connectedNet is left unchanged
        virtual void Disconnect();
+       //Returns true if the port is connected to connectedNet, rather than having been disconnected from it
+       bool IsConnected();
      };
   }
 }
@@ -0,0 +1,322 @@
+#include "NetlistIndex.hpp"
+#include "LogicDesign.hpp"
+#include "BasicDevices.hpp"
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        NetlistIndex::NetlistIndex(LogicDesign *_design) {
+            design = _design;
+            cornerCount = design->technology->GetCornerCount();
+            //The maps from objects to IDs are only needed while the index is built
+            unordered_map<LogicDevice*, CellId> cellIds;
+            cellIds.reserve(design->devices.size());
+            unordered_map<Signal*, NetId> netIds;
+            auto AddNet = [&](Signal *sig) -> NetId {
+                auto existing = netIds.find(sig);
+                if(existing != netIds.end()) {
+                    return existing->second;
+                }
+                NetId id = nets.size();
+                nets.push_back(sig);
+                netIds[sig] = id;
+                return id;
+            };
+
+            //Number cells and record their connections. Each start array has an extra entry marking the end of the
+            //last cell
+            cells.reserve(design->devices.size());
+            cellKind.reserve(design->devices.size());
+            cellDelay.resize(cornerCount);
+            lutPinDelay.resize(cornerCount);
+            for(int c = 0; c < cornerCount; c++) {
+                cellDelay[c].reserve(design->devices.size());
+            }
+            lutPinDelayStart.reserve(design->devices.size() + 1);
+            cellInputStart.reserve(design->devices.size() + 1);
+            cellOutputStart.reserve(design->devices.size() + 1);
+            lutPinDelayStart.push_back(0);
+            cellInputStart.push_back(0);
+            cellOutputStart.push_back(0);
+            for(auto dev : design->devices) {
+                cellIds[dev] = cells.size();
+                AppendCell(dev);
+                for(auto inp : dev->inputPorts) {
+                    cellInputs.push_back(AddNet(inp->connectedNet));
+                }
+                cellInputStart.push_back(cellInputs.size());
+                for(auto outp : dev->outputPorts) {
+                    cellOutputs.push_back(AddNet(outp->connectedNet));
+                }
+                cellOutputStart.push_back(cellOutputs.size());
+            }
+
+            //Top level ports are included so that timing can be traced from them, and the clock so that registers
+            //can be added
+            inputPortNets.reserve(design->inputPorts.size());
+            for(auto inp : design->inputPorts) {
+                inputPortNets.push_back(AddNet(inp->connectedNet));
+            }
+            outputPortNets.reserve(design->outputPorts.size());
+            for(auto outp : design->outputPorts) {
+                outputPortNets.push_back(AddNet(outp->connectedNet));
+            }
+            if(design->clockSignal != nullptr) {
+                clockNet = AddNet(design->clockSignal);
+            }
+
+            //Find drivers and fanout of each net
+            netDriver.assign(nets.size(), NoId);
+            netFanoutStart.reserve(nets.size() + 1);
+            netDelay.assign(cornerCount, vector<double>(nets.size()));
+            netLatency.reserve(nets.size());
+            netSlow.reserve(nets.size());
+            netRoutingDelay.assign(cornerCount, vector<double>(nets.size()));
+            for(NetId i = 0; i < nets.size(); i++) {
+                netFanoutStart.push_back(netFanout.size());
+                LogicDevice *driverDevice = nets[i]->GetDriver();
+                if(driverDevice != nullptr) {
+                    auto driver = cellIds.find(driverDevice);
+                    if(driver != cellIds.end()) {
+                        netDriver[i] = driver->second;
+                    }
+                }
+                for(auto port : nets[i]->fanout) {
+                    if(DeviceInputPort *dip = dynamic_cast<DeviceInputPort*>(port)) {
+                        auto sink = cellIds.find(dip->device);
+                        if(sink != cellIds.end()) {
+                            netFanout.push_back(sink->second);
+                        }
+                    }
+                }
+                netLatency.push_back(nets[i]->latency);
+                netSlow.push_back(nets[i]->isSlow);
+                for(int c = 0; c < cornerCount; c++) {
+                    netDelay[c][i] = nets[i]->delay[c];
+                    netRoutingDelay[c][i] = design->technology->GetRoutingDelay(nets[i], c);
+                }
+            }
+            netRequired.assign(cornerCount, vector<double>(nets.size(), numeric_limits<double>::infinity()));
+            netFanoutStart.push_back(netFanout.size());
+            netPipelined.assign(nets.size(), NoId);
+        }
+
+        void NetlistIndex::AppendCell(LogicDevice *dev) {
+            cells.push_back(dev);
+            if(dev->kind == DEVICE_LUT) {
+                cellKind.push_back(CELL_LUT);
+                for(int c = 0; c < cornerCount; c++) {
+                    cellDelay[c].push_back(0);
+                    for(int pin = 0; pin < dev->inputPorts.size(); pin++) {
+                        lutPinDelay[c].push_back(design->technology->GetLUTPinDelay(static_cast<LUT*>(dev), pin, c));
+                    }
+                }
+            } else if(dev->kind == DEVICE_FLIPFLOP) {
+                cellKind.push_back(CELL_FLIPFLOP);
+                for(int c = 0; c < cornerCount; c++) {
+                    cellDelay[c].push_back(design->technology->GetClockToOutDelay(c));
+                }
+            } else {
+                cellKind.push_back(VendorSpecificDevice::IsKind(dev->kind) ? CELL_VENDOR : CELL_OTHER);
+                for(int c = 0; c < cornerCount; c++) {
+                    cellDelay[c].push_back(0);
+                }
+            }
+            lutPinDelayStart.push_back(lutPinDelay[0].size());
+            cellPipelineDone.push_back(dev->pipelineDone);
+            cellTimingDirty.push_back(false);
+        }
+
+        NetId NetlistIndex::AppendNet(Signal *sig, CellId driver) {
+            NetId id = nets.size();
+            nets.push_back(sig);
+            netDriver.push_back(driver);
+            netFanoutStart.push_back(netFanout.size());
+            netLatency.push_back(sig->latency);
+            netSlow.push_back(sig->isSlow);
+            netPipelined.push_back(NoId);
+            for(int c = 0; c < cornerCount; c++) {
+                netDelay[c].push_back(sig->delay[c]);
+                netRequired[c].push_back(numeric_limits<double>::infinity());
+                netRoutingDelay[c].push_back(design->technology->GetRoutingDelay(sig, c));
+            }
+            return id;
+        }
+
+        CellId NetlistIndex::AddCell(LogicDevice *dev, const vector<NetId> &inputs) {
+            CellId id = cells.size();
+            AppendCell(dev);
+            cellInputs.insert(cellInputs.end(), inputs.begin(), inputs.end());
+            cellInputStart.push_back(cellInputs.size());
+            for(auto outp : dev->outputPorts) {
+                cellOutputs.push_back(AppendNet(outp->connectedNet, id));
+            }
+            cellOutputStart.push_back(cellOutputs.size());
+            for(auto input : inputs) {
+                UpdateRoutingDelay(input);
+            }
+            return id;
+        }
+
+        void NetlistIndex::SetCellInput(CellId cell, int pin, NetId net) {
+            NetId old = cellInputs[cellInputStart[cell] + pin];
+            cellInputs[cellInputStart[cell] + pin] = net;
+            UpdateRoutingDelay(old);
+            UpdateRoutingDelay(net);
+        }
+
+        void NetlistIndex::SetOutputPortNet(int port, NetId net) {
+            NetId old = outputPortNets[port];
+            outputPortNets[port] = net;
+            UpdateRoutingDelay(old);
+            UpdateRoutingDelay(net);
+        }
+
+        void NetlistIndex::UpdateRoutingDelay(NetId net) {
+            for(int c = 0; c < cornerCount; c++) {
+                netRoutingDelay[c][net] = design->technology->GetRoutingDelay(nets[net], c);
+            }
+        }
+
+        int NetlistIndex::GetNetCount() const {
+            return nets.size();
+        }
+
+        int NetlistIndex::GetCellCount() const {
+            return cells.size();
+        }
+
+        NetId NetlistIndex::GetInputPortNet(int port) const {
+            return inputPortNets[port];
+        }
+
+        NetId NetlistIndex::GetOutputPortNet(int port) const {
+            return outputPortNets[port];
+        }
+
+        NetId NetlistIndex::GetClockNet() const {
+            return clockNet;
+        }
+
+        Signal *NetlistIndex::GetNet(NetId net) const {
+            return nets[net];
+        }
+
+        LogicDevice *NetlistIndex::GetCell(CellId cell) const {
+            return cells[cell];
+        }
+
+        CellKind NetlistIndex::GetCellKind(CellId cell) const {
+            return cellKind[cell];
+        }
+
+        CellId NetlistIndex::GetDriver(NetId net) const {
+            return netDriver[net];
+        }
+
+        IdRange<NetId> NetlistIndex::GetInputs(CellId cell) const {
+            return IdRange<NetId>(cellInputs.data() + cellInputStart[cell], cellInputs.data() + cellInputStart[cell + 1]);
+        }
+
+        IdRange<NetId> NetlistIndex::GetOutputs(CellId cell) const {
+            return IdRange<NetId>(cellOutputs.data() + cellOutputStart[cell], cellOutputs.data() + cellOutputStart[cell + 1]);
+        }
+
+        NetId NetlistIndex::GetInput(CellId cell, int pin) const {
+            return cellInputs[cellInputStart[cell] + pin];
+        }
+
+        bool NetlistIndex::HasInput(CellId cell, NetId net) const {
+            for(auto input : GetInputs(cell)) {
+                if(input == net)
+                    return true;
+            }
+            return false;
+        }
+
+        IdRange<double> NetlistIndex::GetLUTPinDelays(CellId cell, int corner) const {
+            const vector<double> &delays = lutPinDelay[corner];
+            return IdRange<double>(delays.data() + lutPinDelayStart[cell], delays.data() + lutPinDelayStart[cell + 1]);
+        }
+
+        int NetlistIndex::GetCornerCount() const {
+            return cornerCount;
+        }
+
+        IdRange<CellId> NetlistIndex::GetFanout(NetId net) const {
+            return IdRange<CellId>(netFanout.data() + netFanoutStart[net], netFanout.data() + netFanoutStart[net + 1]);
+        }
+
+        void NetlistIndex::Levelize(vector<CellId> &order, vector<uint32_t> &levelStart) const {
+            //Count the inputs of each cell driven by another cell, which must be evaluated first
+            vector<int> pending(cells.size(), 0);
+            order.clear();
+            order.reserve(cells.size());
+            levelStart.clear();
+            for(CellId cell = 0; cell < cells.size(); cell++) {
+                if(cellKind[cell] != CELL_FLIPFLOP) {
+                    for(auto input : GetInputs(cell)) {
+                        if(netDriver[input] != NoId) {
+                            pending[cell]++;
+                        }
+                    }
+                }
+                if(pending[cell] == 0) {
+                    order.push_back(cell);
+                }
+            }
+            //Each level is the cells whose last pending driver was in the level before
+            size_t levelBegin = 0;
+            while(levelBegin < order.size()) {
+                size_t levelEnd = order.size();
+                levelStart.push_back(levelBegin);
+                for(size_t i = levelBegin; i < levelEnd; i++) {
+                    for(auto output : GetOutputs(order[i])) {
+                        if(netDriver[output] != order[i])
+                            continue;
+                        for(auto sink : GetFanout(output)) {
+                            if(cellKind[sink] == CELL_FLIPFLOP)
+                                continue;
+                            pending[sink]--;
+                            if(pending[sink] == 0) {
+                                order.push_back(sink);
+                            }
+                        }
+                    }
+                }
+                levelBegin = levelEnd;
+            }
+            if(order.size() < cells.size()) {
+                levelStart.push_back(order.size());
+                for(CellId cell = 0; cell < cells.size(); cell++) {
+                    if(pending[cell] > 0) {
+                        order.push_back(cell);
+                    }
+                }
+            }
+            levelStart.push_back(order.size());
+        }
+
+        void NetlistIndex::StoreNetTiming(NetId net) {
+            nets[net]->latency = netLatency[net];
+            nets[net]->isSlow = netSlow[net];
+            nets[net]->slack = numeric_limits<double>::infinity();
+            for(int c = 0; c < cornerCount; c++) {
+                nets[net]->delay[c] = netDelay[c][net];
+                nets[net]->slack = min(nets[net]->slack, netRequired[c][net] - netDelay[c][net]);
+            }
+        }
+
+        void NetlistIndex::LoadNetTiming(NetId net) {
+            for(int c = 0; c < cornerCount; c++) {
+                netDelay[c][net] = nets[net]->delay[c];
+            }
+        }
+
+        void NetlistIndex::StoreTiming() {
+            for(NetId i = 0; i < nets.size(); i++) {
+                StoreNetTiming(i);
+            }
+        }
+    }
+}
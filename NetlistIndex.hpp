@@ -0,0 +1,145 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "LogicDevice.hpp"
+#include "Signal.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    class LogicDesign;
+
+    typedef uint32_t NetId;
+    typedef uint32_t CellId;
+    //Used for a missing net or cell, such as the driver of an undriven net
+    const uint32_t NoId = 0xFFFFFFFF;
+
+    //Broad class of a cell, so that traversals don't need to use dynamic_cast
+    enum CellKind : uint8_t {
+      CELL_LUT,
+      CELL_FLIPFLOP,
+      CELL_VENDOR,
+      CELL_OTHER
+    };
+
+    //A view of a contiguous run of IDs
+    template<typename T> class IdRange {
+    public:
+      IdRange(const T *_first, const T *_last) : first(_first), last(_last) {};
+      const T *begin() const { return first; };
+      const T *end() const { return last; };
+      int size() const { return last - first; };
+      T operator[](int i) const { return first[i]; };
+    private:
+      const T *first, *last;
+    };
+
+    /*
+    A compact read-only snapshot of the netlist, for analyses that walk the whole design
+    Nets and cells are numbered with 32-bit IDs, connectivity is held in contiguous arrays and timing information in
+    arrays indexed by net ID, rather than following pointers between individually allocated ports and signals.
+    Cells are numbered in the same order as LogicDesign::devices
+    Timing analysis, the timing report and the pipeliner run on the index. The pipeliner keeps it up to date as it
+    adds registers and reconnects inputs, alongside the object graph, and copies the timing back to the Signal objects
+    once it is done. Elsewhere the object graph is edited directly, so the index must be rebuilt once it has been
+    changed and is best kept no longer than the analysis that uses it
+    */
+    class NetlistIndex {
+    public:
+      NetlistIndex(LogicDesign *_design);
+
+      int GetNetCount() const;
+      int GetCellCount() const;
+      //Return the ID of the net connected to a top level input or output, numbered in the order of
+      //LogicDesign::inputPorts or LogicDesign::outputPorts
+      NetId GetInputPortNet(int port) const;
+      NetId GetOutputPortNet(int port) const;
+      //Return the ID of the design's clock, or NoId if it has none
+      NetId GetClockNet() const;
+      Signal *GetNet(NetId net) const;
+      LogicDevice *GetCell(CellId cell) const;
+      CellKind GetCellKind(CellId cell) const;
+
+      //Return the cell driving a net, or NoId if it is undriven or driven by a top level input or constant
+      CellId GetDriver(NetId net) const;
+      //Ranges are invalidated by adding a cell
+      IdRange<NetId> GetInputs(CellId cell) const;
+      IdRange<NetId> GetOutputs(CellId cell) const;
+      NetId GetInput(CellId cell, int pin) const;
+      //Return the cells with an input connected to a net when the index was built. Inputs reconnected since are still
+      //included, and cells added since are not
+      IdRange<CellId> GetFanout(NetId net) const;
+      //Return true if an input of a cell is currently connected to a net
+      bool HasInput(CellId cell, NetId net) const;
+
+      //Changes made alongside the same changes to the object graph. Routing delays are updated from the fanout of
+      //the Signal objects, so the object graph must be changed first
+      //Add a cell created since the index was built, given the nets connected to its inputs. Its outputs are added
+      //as new nets, with the timing of their Signal objects
+      CellId AddCell(LogicDevice *dev, const vector<NetId> &inputs);
+      void SetCellInput(CellId cell, int pin, NetId net);
+      void SetOutputPortNet(int port, NetId net);
+      //Update the routing delay of a net after its fanout has changed
+      void UpdateRoutingDelay(NetId net);
+
+      //Sort the cells into levels for timing analysis, such that each cell is in a later level than the cells driving
+      //its inputs. Flip flops start a level 0 along with cells that have no drivers, as their outputs don't depend on
+      //their inputs. Level i is order[levelStart[i]] to order[levelStart[i + 1] - 1]. Cells in combinational loops
+      //can't be ordered, and are placed in an extra final level
+      void Levelize(vector<CellId> &order, vector<uint32_t> &levelStart) const;
+
+      //Number of delay corners of the technology. Delays are held separately for each corner, indexed by corner and
+      //then by net or cell
+      int GetCornerCount() const;
+
+      //Per-net timing information, initialised from the Signal objects
+      vector<vector<double>> netDelay;
+      vector<int> netLatency;
+      vector<bool> netSlow;
+      //Time each net must be valid by to meet setup requirements, infinite until required times are propagated
+      vector<vector<double>> netRequired;
+      //Clock-to-output delay of each flip flop, 0 for other cells
+      vector<vector<double>> cellDelay;
+      //Routing delay from the driver of each net to the inputs it drives
+      vector<vector<double>> netRoutingDelay;
+      //Return the delay from each input of a LUT to its output at a corner, or an empty range for other cells
+      IdRange<double> GetLUTPinDelays(CellId cell, int corner) const;
+
+      //Copy the timing information of a net back to its Signal object
+      void StoreNetTiming(NetId net);
+      //Update the delays of a net from its Signal object, after they have been computed through it
+      void LoadNetTiming(NetId net);
+      //Copy the timing information of all nets back to their Signal objects
+      void StoreTiming();
+
+      //State of the pipeliner's walks: the net a register added after each net drives, or NoId, and whether each cell
+      //has been pipelined and whether the delays of its outputs may be out of date. Cells start pipelined if their
+      //LogicDevice is
+      vector<NetId> netPipelined;
+      vector<bool> cellPipelineDone, cellTimingDirty;
+    private:
+      LogicDesign *design;
+      int cornerCount;
+
+      vector<Signal*> nets;
+      vector<NetId> inputPortNets, outputPortNets;
+      NetId clockNet = NoId;
+      vector<CellId> netDriver;
+      vector<uint32_t> netFanoutStart;
+      vector<CellId> netFanout;
+
+      vector<LogicDevice*> cells;
+      vector<CellKind> cellKind;
+      vector<uint32_t> cellInputStart, cellOutputStart;
+      vector<NetId> cellInputs, cellOutputs;
+      vector<uint32_t> lutPinDelayStart;
+      vector<vector<double>> lutPinDelay;
+
+      //Add the kind, delays and per-cell state of a cell, leaving its connections to be added by the caller
+      void AppendCell(LogicDevice *dev);
+      //Add a net driven by a cell added since the index was built
+      NetId AppendNet(Signal *sig, CellId driver);
+    };
+  }
+}
@@ -0,0 +1,166 @@
+#include "NetlistReader.hpp"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        MappedFile::MappedFile() {
+
+        }
+
+        MappedFile::~MappedFile() {
+            Close();
+        }
+
+        bool MappedFile::Open(string filename) {
+            Close();
+            int fd = open(filename.c_str(), O_RDONLY);
+            if(fd == -1) {
+                return false;
+            }
+            struct stat st;
+            if((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+                void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(mapped != MAP_FAILED) {
+                    madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+                    data = static_cast<const char*>(mapped);
+                    size = st.st_size;
+                    isMapped = true;
+                }
+            }
+            close(fd);
+            if(!isMapped) {
+                //Empty files and things such as pipes can't be mapped, so are read normally
+                ifstream in(filename, ios::binary);
+                if(!in.is_open()) {
+                    return false;
+                }
+                buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+                data = buffer.data();
+                size = buffer.size();
+            }
+            return true;
+        }
+
+        void MappedFile::Close() {
+            if(isMapped) {
+                munmap(const_cast<char*>(data), size);
+            }
+            isMapped = false;
+            data = nullptr;
+            size = 0;
+            buffer.clear();
+        }
+
+        const char *MappedFile::GetData() const {
+            return data;
+        }
+
+        size_t MappedFile::GetSize() const {
+            return size;
+        }
+
+        NetlistTokenizer::NetlistTokenizer(const char *_begin, const char *_end) {
+            pos = _begin;
+            end = _end;
+        }
+
+        //Matches the characters skipped by stream extraction of strings
+        static inline bool IsSpace(char c) {
+            return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\v') || (c == '\f');
+        }
+
+        bool NetlistTokenizer::NextLine(vector<Token> &tokens) {
+            tokens.clear();
+            if(pos >= end) {
+                return false;
+            }
+            bool inComment = false;
+            while((pos < end) && (*pos != '\n')) {
+                if(*pos == '#') {
+                    inComment = true;
+                }
+                if(inComment || IsSpace(*pos)) {
+                    pos++;
+                    continue;
+                }
+                Token tok;
+                tok.data = pos;
+                while((pos < end) && (*pos != '#') && !IsSpace(*pos)) {
+                    pos++;
+                }
+                tok.length = pos - tok.data;
+                tokens.push_back(tok);
+            }
+            //Skip the newline itself
+            if(pos < end) {
+                pos++;
+            }
+            return true;
+        }
+
+        bool ParsedNetlist::Load(string filename) {
+            if(!file.Open(filename)) {
+                return false;
+            }
+            NetlistTokenizer tokenizer(file.GetData(), file.GetData() + file.GetSize());
+            vector<Token> lineTokens;
+            while(tokenizer.NextLine(lineTokens)) {
+                if(lineTokens.size() == 0)
+                    continue;
+                lineStart.push_back(tokens.size());
+                tokens.insert(tokens.end(), lineTokens.begin(), lineTokens.end());
+                if((lineTokens.size() >= 2) && (lineTokens[0] == "INCLUDE")) {
+                    string name = lineTokens[1].str();
+                    if(find(includes.begin(), includes.end(), name) == includes.end()) {
+                        includes.push_back(name);
+                    }
+                }
+            }
+            lineStart.push_back(tokens.size());
+            return true;
+        }
+
+        int ParsedNetlist::GetLineCount() const {
+            return int(lineStart.size()) - 1;
+        }
+
+        void ParsedNetlist::GetLine(int line, vector<Token> &lineTokens) const {
+            lineTokens.assign(tokens.begin() + lineStart[line], tokens.begin() + lineStart[line + 1]);
+        }
+
+        void ParsedNetlist::FindIncludes(const char *begin, const char *end, vector<string> &includes) {
+            const char *pos = begin;
+            static const char keyword[] = "INCLUDE";
+            const size_t keywordLength = sizeof(keyword) - 1;
+            while(pos < end) {
+                const char *lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+                if(lineEnd == nullptr) {
+                    lineEnd = end;
+                }
+                while((pos < lineEnd) && IsSpace(*pos)) {
+                    pos++;
+                }
+                //Only lines starting with the keyword need to be split into tokens
+                if((size_t(lineEnd - pos) > keywordLength) && (memcmp(pos, keyword, keywordLength) == 0) && IsSpace(pos[keywordLength])) {
+                    NetlistTokenizer tokenizer(pos, lineEnd);
+                    vector<Token> lineTokens;
+                    tokenizer.NextLine(lineTokens);
+                    if((lineTokens.size() >= 2) && (lineTokens[0] == "INCLUDE")) {
+                        string name = lineTokens[1].str();
+                        if(find(includes.begin(), includes.end(), name) == includes.end()) {
+                            includes.push_back(name);
+                        }
+                    }
+                }
+                pos = lineEnd + 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    //A token within a netlist, referring to the netlist text rather than holding a copy of it
+    struct Token {
+      const char *data = nullptr;
+      size_t length = 0;
+
+      string str() const { return string(data, length); };
+      bool operator==(const char *other) const { return (strncmp(data, other, length) == 0) && (other[length] == '\0'); };
+      bool operator!=(const char *other) const { return !(*this == other); };
+    };
+
+    inline string operator+(const string &a, const Token &b) {
+      string result = a;
+      result.append(b.data, b.length);
+      return result;
+    }
+
+    /*
+    A read only view of a file's contents, memory mapped where possible so that large netlists do not need to be
+    copied into memory
+    */
+    class MappedFile {
+    public:
+      MappedFile();
+      ~MappedFile();
+      //Open a file, returning false if it cannot be read
+      bool Open(string filename);
+      void Close();
+      const char *GetData() const;
+      size_t GetSize() const;
+    private:
+      const char *data = nullptr;
+      size_t size = 0;
+      bool isMapped = false;
+      vector<char> buffer; //used if the file cannot be mapped
+      MappedFile(const MappedFile &other);
+      MappedFile &operator=(const MappedFile &other);
+    };
+
+    /*
+    Splits netlist text into lines of whitespace separated tokens, with anything after a '#' ignored
+    Tokens refer directly to the text, which must outlive them
+    */
+    class NetlistTokenizer {
+    public:
+      NetlistTokenizer(const char *_begin, const char *_end);
+      //Read the tokens of the next line into a vector, returning false at the end of the text
+      //Lines without any tokens are returned as an empty vector
+      bool NextLine(vector<Token> &tokens);
+    private:
+      const char *pos, *end;
+    };
+
+    /*
+    A netlist file that has been read and split into tokens in advance, so it can be instantiated repeatedly (as
+    submodules are) without being read again. Only lines containing tokens are kept
+    */
+    class ParsedNetlist {
+    public:
+      //Read and tokenize a netlist file, returning false if it could not be opened
+      bool Load(string filename);
+      int GetLineCount() const;
+      //Copy the tokens of a line into a vector
+      void GetLine(int line, vector<Token> &lineTokens) const;
+      //Names of the submodules included by the netlist, in order of first use
+      vector<string> includes;
+
+      //Find the names of the submodules included by some netlist text, without tokenizing all of it
+      static void FindIncludes(const char *begin, const char *end, vector<string> &includes);
+    private:
+      MappedFile file;
+      vector<Token> tokens;
+      vector<uint32_t> lineStart;
+    };
+
+    /*
+    Perfect hash table mapping a fixed set of keywords to values
+    A hash seed is chosen when the table is built such that no two keywords share a slot, so a lookup is a single hash
+    and at most one string comparison
+    */
+    template<typename T> class KeywordTable {
+    public:
+      KeywordTable(const vector<pair<string, T>> &keywords) {
+        size_t tableSize = 1;
+        while(tableSize < (2 * keywords.size())) {
+          tableSize <<= 1;
+        }
+        for(seed = 1; ; seed++) {
+          slots.assign(tableSize, -1);
+          bool collision = false;
+          for(int i = 0; i < int(keywords.size()); i++) {
+            size_t slot = Hash(keywords[i].first.data(), keywords[i].first.size());
+            if(slots[slot] != -1) {
+              collision = true;
+              break;
+            }
+            slots[slot] = i;
+          }
+          if(!collision)
+            break;
+          //Grow the table if seeds are not easily found
+          if((seed % 64) == 0) {
+            tableSize <<= 1;
+          }
+        }
+        for(auto kw : keywords) {
+          names.push_back(kw.first);
+          values.push_back(kw.second);
+        }
+      };
+
+      //Look up a keyword, returning false if it is not in the table
+      bool Find(const Token &token, T &value) const {
+        int index = slots[Hash(token.data, token.length)];
+        if((index == -1) || (names[index].size() != token.length) || (memcmp(names[index].data(), token.data, token.length) != 0)) {
+          return false;
+        }
+        value = values[index];
+        return true;
+      };
+    private:
+      uint32_t seed;
+      vector<int> slots;
+      vector<string> names;
+      vector<T> values;
+
+      size_t Hash(const char *str, size_t length) const {
+        uint32_t h = 2166136261U ^ seed;
+        for(size_t i = 0; i < length; i++) {
+          h = (h ^ uint8_t(str[i])) * 16777619U;
+        }
+        h ^= h >> 15;
+        return h & (slots.size() - 1);
+      };
+    };
+  }
+}
@@ -102,21 +102,21 @@ namespace SynthFramework {
                     } break;
                 case OPER_U_REG:
                     for(int j = 0; j < output->width; j++) {
-                        topLevel->devices.push_back(new FlipFlop(GetInputSignal(0, j, topLevel), topLevel->clockSignal, output->signals[j]));
+                        topLevel->AddDevice(new FlipFlop(GetInputSignal(0, j, topLevel), topLevel->clockSignal, output->signals[j]));
                     }
                     break;
                 case OPER_U_SREG:
                     for(int j = 0; j < output->width; j++) {
                         FlipFlop *ff = new FlipFlop(GetInputSignal(0, j, topLevel), topLevel->clockSignal, output->signals[j]);
                         ff->isShift = true;
-                        topLevel->devices.push_back(ff);
+                        topLevel->AddDevice(ff);
                     }
                     break;
                 case OPER_U_SEREG:
                     for(int j = 0; j < output->width; j++) {
                         FlipFlop *ff = new FlipFlop(GetInputSignal(0, j, topLevel), topLevel->clockSignal, output->signals[j], GetInputSignal(1, 0, topLevel));
                         ff->isShift = true;
-                        topLevel->devices.push_back(ff);
+                        topLevel->AddDevice(ff);
                     }
                     break;
                 case OPER_B_DIV:
@@ -139,7 +139,7 @@ namespace SynthFramework {
                     for(int i = 0; i < inputs.size(); i++) {
                         inPins.push_back(GetInputSignal(i, j, topLevel));
                     }
-                    topLevel->devices.push_back(new LUT(lutType, inPins, outPin));
+                    topLevel->AddDevice(new LUT(lutType, inPins, outPin));
                 }
             }
         };
@@ -156,9 +156,9 @@ namespace SynthFramework {
               inPins.push_back(GetInputSignal(i, j, topLevel));
             }
             if(inv) {
-              topLevel->devices.push_back(new LUT(Device_XOR2, inPins, compareOuts->signals[j]));
+              topLevel->AddDevice(new LUT(Device_XOR2, inPins, compareOuts->signals[j]));
             } else {
-              topLevel->devices.push_back(new LUT(Device_XNOR2, inPins, compareOuts->signals[j]));
+              topLevel->AddDevice(new LUT(Device_XNOR2, inPins, compareOuts->signals[j]));
             }
           }
           Signal *result = ConvertToBoolean(compareOuts, topLevel, Device_AND2);
@@ -194,7 +194,7 @@ namespace SynthFramework {
                         Signal *inPin = GetInputSignal(i, j, topLevel);
                         if((i == 1) && isSubtract) { //need to invert B input for a subtractor
                             Signal *invPin = topLevel->CreateSignal(name + "_invB_" + to_string(j));
-                            topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{inPin}, invPin));
+                            topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{inPin}, invPin));
                             inPins.push_back(invPin);
                         } else {
                             inPins.push_back(inPin);
@@ -202,8 +202,8 @@ namespace SynthFramework {
                     }
                     inPins.push_back(carryChain); //carry in
                     Signal *carryOut = topLevel->CreateSignal(name + "_CO_" + to_string(j));
-                    topLevel->devices.push_back(new LUT(Device_FULLADD_SUM, inPins, outPin));
-                    topLevel->devices.push_back(new LUT(Device_FULLADD_CARRY, inPins, carryOut));
+                    topLevel->AddDevice(new LUT(Device_FULLADD_SUM, inPins, outPin));
+                    topLevel->AddDevice(new LUT(Device_FULLADD_CARRY, inPins, carryOut));
                     carryChain = carryOut;
                 }
             }
@@ -249,7 +249,7 @@ namespace SynthFramework {
                         nextLevel.push_back(currentSet[i]);
                     } else {
                         Signal *or_outp = topLevel->CreateSignal(name + "_" + bus->name + "_OP" + to_string(treeLevel) + "_" + to_string(i/2));
-                        topLevel->devices.push_back(new LUT(opType, vector<Signal*>{currentSet[i], currentSet[i+1]}, or_outp));
+                        topLevel->AddDevice(new LUT(opType, vector<Signal*>{currentSet[i], currentSet[i+1]}, or_outp));
                         nextLevel.push_back(or_outp);
                     }
                 }
@@ -265,7 +265,7 @@ namespace SynthFramework {
                 inputBools.push_back(ConvertToBoolean(inputs[i], topLevel));
             }
             if(output->width > 0) { //output bit 0 is result of logical operation
-                topLevel->devices.push_back(new LUT(lutType, inputBools, output->signals[0]));
+                topLevel->AddDevice(new LUT(lutType, inputBools, output->signals[0]));
             }
             for(int j = 1; j < output->width; j++) { //output bits 1..n-1 are 0
                 output->signals[j]->ConnectTo(topLevel->gnd);
@@ -279,7 +279,7 @@ namespace SynthFramework {
                 inputSignals.push_back(GetInputSignal(2, j, topLevel)); //input 0 is mux input A, i.e. if false
                 inputSignals.push_back(GetInputSignal(1, j, topLevel)); //input 1 is mux input B, i.e. if true
                 inputSignals.push_back(condition); //input 2 is mux input S, i.e. condition
-                topLevel->devices.push_back(new LUT(Device_MUX2_1, inputSignals, output->signals[j]));
+                topLevel->AddDevice(new LUT(Device_MUX2_1, inputSignals, output->signals[j]));
             }
         }
 
@@ -328,7 +328,7 @@ namespace SynthFramework {
                         muxIn.push_back(intSignals[shiftK]);
                     }
 
-                    topLevel->devices.push_back(new LUT(Device_MUX2_1, muxIn, muxOut));
+                    topLevel->AddDevice(new LUT(Device_MUX2_1, muxIn, muxOut));
 
                     muxOutputs.push_back(muxOut);
                 }
@@ -368,17 +368,17 @@ namespace SynthFramework {
                 Signal *inv_b = topLevel->CreateSignal(name + "_invb_" + to_string(j));
                 //2's complement compare requires MSB comparison to be reversed
                 if(is_signed && (j == (inputSize - 1))) {
-                    topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{GetInputSignal(in1, j, topLevel)}, inv_b));
-                    topLevel->devices.push_back(new LUT(Device_AND3, vector<Signal*>{GetInputSignal(in2, j, topLevel), inv_b, eqChain}, compareOuts->signals[j]));
+                    topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{GetInputSignal(in1, j, topLevel)}, inv_b));
+                    topLevel->AddDevice(new LUT(Device_AND3, vector<Signal*>{GetInputSignal(in2, j, topLevel), inv_b, eqChain}, compareOuts->signals[j]));
                 } else {
-                    topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{GetInputSignal(in2, j, topLevel)}, inv_b));
-                    topLevel->devices.push_back(new LUT(Device_AND3, vector<Signal*>{GetInputSignal(in1, j, topLevel), inv_b, eqChain}, compareOuts->signals[j]));
+                    topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{GetInputSignal(in2, j, topLevel)}, inv_b));
+                    topLevel->AddDevice(new LUT(Device_AND3, vector<Signal*>{GetInputSignal(in1, j, topLevel), inv_b, eqChain}, compareOuts->signals[j]));
                 }
 
                 Signal *xnoro = topLevel->CreateSignal(name + "_xnor_" + to_string(j));
-                topLevel->devices.push_back(new LUT(Device_XNOR2, vector<Signal*>{GetInputSignal(0, j, topLevel), GetInputSignal(1, j, topLevel)}, xnoro));
+                topLevel->AddDevice(new LUT(Device_XNOR2, vector<Signal*>{GetInputSignal(0, j, topLevel), GetInputSignal(1, j, topLevel)}, xnoro));
                 Signal *eqOut = topLevel->CreateSignal(name + "_eq_" + to_string(j));
-                topLevel->devices.push_back(new LUT(Device_AND2, vector<Signal*>{eqChain, xnoro}, eqOut));
+                topLevel->AddDevice(new LUT(Device_AND2, vector<Signal*>{eqChain, xnoro}, eqOut));
                 eqChain = eqOut;
             }
             if(output->width > 0) { //output bit 0 is boolean conversion compareOuts
@@ -386,7 +386,7 @@ namespace SynthFramework {
                 Signal *result;
                 if(eq) {
                     result = topLevel->CreateSignal(name + "_res");
-                    topLevel->devices.push_back(new LUT(Device_OR2, vector<Signal*>{compareResult, eqChain}, result));
+                    topLevel->AddDevice(new LUT(Device_OR2, vector<Signal*>{compareResult, eqChain}, result));
                 } else {
                     result = compareResult;
                 }
@@ -535,7 +535,7 @@ namespace SynthFramework {
                     } else {
                         bitin = shifted->signals[j];
                     }
-                    topLevel->devices.push_back(new LUT(Device_AND2, vector<Signal*>{bitin, inputs[inb]->signals[i]}, anded->signals[j]));
+                    topLevel->AddDevice(new LUT(Device_AND2, vector<Signal*>{bitin, inputs[inb]->signals[i]}, anded->signals[j]));
                 }
 
 
@@ -626,7 +626,7 @@ namespace SynthFramework {
 
                 if(inputs[1]->is_signed) {
                     Signal *xorres = topLevel->CreateSignal(name + "_xor1_" + to_string(i));
-                    topLevel->devices.push_back(new LUT(Device_XOR2, vector<Signal*>{sign1, inputs[1]->signals.back()}, xorres));
+                    topLevel->AddDevice(new LUT(Device_XOR2, vector<Signal*>{sign1, inputs[1]->signals.back()}, xorres));
                     sign1 = xorres;
                 }
                 Bus *sign1n = new Bus();
@@ -634,7 +634,7 @@ namespace SynthFramework {
                 sign1n->width = 1;
                 sign1n->is_signed = false;
                 topLevel->AddBus(sign1n);
-                topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{sign1}, sign1n->signals[0]));
+                topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{sign1}, sign1n->signals[0]));
                 Bus *ashift = new Bus();
                 ashift->name = name + "_As" + to_string(i);
                 ashift->width = A->width;
@@ -659,7 +659,7 @@ namespace SynthFramework {
                 addamt->is_signed = M->is_signed;
                 topLevel->AddBus(addamt);
                 for(int j = 0; j < addamt->width; j++) {
-                    topLevel->devices.push_back(new LUT(Device_XOR2, vector<Signal*>{M->signals[j], sign1n->signals[0]}, addamt->signals[j]));
+                    topLevel->AddDevice(new LUT(Device_XOR2, vector<Signal*>{M->signals[j], sign1n->signals[0]}, addamt->signals[j]));
                 }
 
                 Bus *anext = new Bus();
@@ -675,11 +675,11 @@ namespace SynthFramework {
                 Signal *sign2 = anext->signals.back();
                 if(inputs[1]->is_signed) {
                     Signal *xorres2 = topLevel->CreateSignal(name + "_xor2_" + to_string(i));
-                    topLevel->devices.push_back(new LUT(Device_XOR2, vector<Signal*>{sign2, inputs[1]->signals.back()}, xorres2));
+                    topLevel->AddDevice(new LUT(Device_XOR2, vector<Signal*>{sign2, inputs[1]->signals.back()}, xorres2));
                     sign2 = xorres2;
                 }
 
-                topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{sign2}, qshift->signals[0]));
+                topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{sign2}, qshift->signals[0]));
 
                 Q = qshift;
                 A = anext;
@@ -699,14 +699,23 @@ namespace SynthFramework {
         }
 
 
-        bool GetOperationByName(string name, OperationType &type) {
-            for(auto oper : OperationInfo) {
-                if(oper.second.name == name) {
-                    type = oper.first;
-                    return true;
+        bool GetOperationByName(const Token &name, OperationType &type) {
+            //Built on first use, as OperationInfo must be initialised first
+            static const KeywordTable<OperationType> operationKeywords([] {
+                vector<pair<string, OperationType>> keywords;
+                for(auto oper : OperationInfo) {
+                    keywords.push_back(make_pair(oper.second.name, oper.first));
                 }
-            }
-            return false;
+                return keywords;
+            }());
+            return operationKeywords.Find(name, type);
+        }
+
+        bool GetOperationByName(const string &name, OperationType &type) {
+            Token tok;
+            tok.data = name.data();
+            tok.length = name.size();
+            return GetOperationByName(tok, type);
         }
 
         map<OperationType, OperationTypeInfo> OperationInfo = {
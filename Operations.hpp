@@ -4,6 +4,7 @@
 #include <map>
 #include "Signal.hpp"
 #include "BasicDevices.hpp"
+#include "NetlistReader.hpp"
 using namespace std;
 namespace SynthFramework {
   namespace Polymer {
@@ -43,7 +44,7 @@ namespace SynthFramework {
       OPER_CONNECT, //connect two signals together
     };
 
-    class Operation {
+    class Operation : public ArenaObject {
     public:
       Operation();
       Operation(OperationType _type, vector<Bus*> ins, Bus *out);
@@ -94,7 +95,8 @@ namespace SynthFramework {
       int nOperands; //Number of operands
     };
     //Look up an operation by name, setting type if found
-    bool GetOperationByName(string name, OperationType &type);
+    bool GetOperationByName(const Token &name, OperationType &type);
+    bool GetOperationByName(const string &name, OperationType &type);
 
     extern map<OperationType, OperationTypeInfo> OperationInfo;
   }
@@ -0,0 +1,256 @@
+#include "Optimiser.hpp"
+#include "LogicDesign.hpp"
+#include "Util.hpp"
+#include <utility>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        Optimiser::Optimiser(LogicDesign *_design) {
+            design = _design;
+        }
+
+        void Optimiser::Run() {
+            deviceByIndex = design->devices;
+            int deviceCount = deviceByIndex.size();
+            optimiseQueued.assign(deviceCount, false);
+            fanoutQueued.assign(deviceCount, false);
+            rehashQueued.assign(deviceCount, false);
+            purgeQueued.assign(deviceCount, false);
+            design->structuralHash.Clear();
+
+            //Initially everything needs to be looked at once
+            for(int i = 0; i < deviceCount; i++) {
+                deviceByIndex[i]->optimiseIndex = i;
+                optimiseNextPass.push(i);
+                optimiseQueued[i] = true;
+                fanoutCandidates.push_back(i);
+                fanoutQueued[i] = true;
+                rehashNextPass.push(i);
+                rehashQueued[i] = true;
+            }
+
+            do {
+                didOptimise = false;
+                swap(optimiseThisPass, optimiseNextPass);
+                swap(rehashThisPass, rehashNextPass);
+
+                //Run device specific optimisations
+                phase = PHASE_OPTIMISE;
+                while(!optimiseThisPass.empty()) {
+                    position = optimiseThisPass.top();
+                    optimiseThisPass.pop();
+                    optimiseQueued[position] = false;
+                    if(purgeQueued[position])
+                        continue;
+                    LogicDevice *dev = deviceByIndex[position];
+                    //Record what the device was connected to, as this is what will be affected by any change
+                    oldNets.clear();
+                    oldFanout.clear();
+                    for(auto inp : dev->inputPorts) {
+                        oldNets.push_back(inp->connectedNet);
+                    }
+                    for(auto outp : dev->outputPorts) {
+                        oldNets.push_back(outp->connectedNet);
+                        GetFanoutDevices(outp->connectedNet, oldFanout);
+                    }
+                    int oldInputCount = dev->inputPorts.size();
+                    bool optimised = dev->OptimiseDevice(design);
+                    IndexNewDevices();
+                    if(optimised) {
+                        didOptimise = true;
+                    }
+                    //Merging duplicate inputs of a LUT is not reported as an optimisation, but still changes the device
+                    if(optimised || (dev->inputPorts.size() != oldInputCount)) {
+                        DeviceChanged(dev);
+                    }
+                }
+
+                //Optimise away devices with no fanout
+                phase = PHASE_FANOUT;
+                vector<int> candidates;
+                swap(candidates, fanoutCandidates);
+                for(auto index : candidates) {
+                    fanoutQueued[index] = false;
+                    if(purgeQueued[index])
+                        continue;
+                    LogicDevice *dev = deviceByIndex[index];
+                    if(!HasFanout(dev)) {
+                        didOptimise = true;
+                        PrintMessage(MSG_DEBUG, "device ===" + dev->name + "=== has no fanout and will be removed");
+                        purgeQueued[index] = true;
+                        design->structuralHash.Remove(dev);
+                        devicesToPurge.push_back(index);
+                    }
+                }
+
+                //Optimise away duplicate devices
+                phase = PHASE_DUPLICATES;
+                while(!rehashThisPass.empty()) {
+                    position = rehashThisPass.top();
+                    rehashThisPass.pop();
+                    rehashQueued[position] = false;
+                    if(purgeQueued[position])
+                        continue;
+                    Rehash(deviceByIndex[position]);
+                }
+
+                phase = PHASE_PURGE;
+                for(auto dtp : devicesToPurge) {
+                    PurgeDevice(deviceByIndex[dtp]);
+                }
+                devicesToPurge.clear();
+            } while(didOptimise);
+
+            //Remove purged devices from the design, keeping the order of the remainder
+            design->devices.clear();
+            for(int i = 0; i < deviceByIndex.size(); i++) {
+                if(!purgeQueued[i]) {
+                    design->devices.push_back(deviceByIndex[i]);
+                    deviceByIndex[i]->optimiseIndex = -1;
+                } else {
+                    design->DestroyDevice(deviceByIndex[i]);
+                }
+            }
+            deviceByIndex.clear();
+            design->structuralHash.Clear();
+        }
+
+        void Optimiser::IndexNewDevices() {
+            //Devices are only ever added to the end of the design's list while optimising
+            for(int i = deviceByIndex.size(); i < design->devices.size(); i++) {
+                LogicDevice *dev = design->devices[i];
+                dev->optimiseIndex = i;
+                deviceByIndex.push_back(dev);
+                optimiseQueued.push_back(false);
+                fanoutQueued.push_back(false);
+                rehashQueued.push_back(false);
+                purgeQueued.push_back(false);
+                QueueOptimise(dev);
+                QueueFanoutCheck(dev);
+                QueueRehash(dev);
+            }
+        }
+
+        void Optimiser::QueueOptimise(LogicDevice *dev) {
+            int index = dev->optimiseIndex;
+            if((index == -1) || optimiseQueued[index] || purgeQueued[index])
+                return;
+            optimiseQueued[index] = true;
+            //Devices not yet reached in this pass will be optimised in this pass, as they would be in a full sweep
+            if((phase == PHASE_OPTIMISE) && (index > position)) {
+                optimiseThisPass.push(index);
+            } else {
+                optimiseNextPass.push(index);
+            }
+        }
+
+        void Optimiser::QueueFanoutCheck(LogicDevice *dev) {
+            int index = dev->optimiseIndex;
+            if((index == -1) || fanoutQueued[index] || purgeQueued[index])
+                return;
+            fanoutQueued[index] = true;
+            fanoutCandidates.push_back(index);
+        }
+
+        void Optimiser::QueueRehash(LogicDevice *dev) {
+            int index = dev->optimiseIndex;
+            if((index == -1) || rehashQueued[index] || purgeQueued[index])
+                return;
+            rehashQueued[index] = true;
+            if(((phase == PHASE_DUPLICATES) && (index <= position)) || (phase == PHASE_PURGE)) {
+                rehashNextPass.push(index);
+            } else {
+                rehashThisPass.push(index);
+            }
+        }
+
+        void Optimiser::QueueInputsChanged(LogicDevice *dev) {
+            QueueOptimise(dev);
+            QueueRehash(dev);
+        }
+
+        void Optimiser::DeviceChanged(LogicDevice *dev) {
+            //The device itself may be able to be optimised further, may have lost its fanout, or may now be
+            //identical to another device
+            QueueInputsChanged(dev);
+            QueueFanoutCheck(dev);
+            //Devices driving the old inputs may have lost their fanout
+            for(auto net : oldNets) {
+                //The net may since have been merged into another
+                LogicDevice *driver = net->Resolve()->GetDriver();
+                if(driver != nullptr) {
+                    QueueFanoutCheck(driver);
+                }
+            }
+            //Devices previously driven by this one may now have constant or duplicate inputs
+            for(auto fanout : oldFanout) {
+                if(fanout != dev) {
+                    QueueInputsChanged(fanout);
+                }
+            }
+        }
+
+        bool Optimiser::HasFanout(LogicDevice *dev) {
+            for(auto outPin : dev->outputPorts) {
+                if(outPin->connectedNet->GetFanout() > 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Optimiser::Rehash(LogicDevice *dev) {
+            design->structuralHash.Remove(dev);
+            LogicDevice *existing = design->structuralHash.FindEquivalent(dev);
+            if(existing != nullptr) {
+                MergeDuplicate(existing, dev);
+            } else {
+                design->structuralHash.Insert(dev);
+            }
+        }
+
+        void Optimiser::MergeDuplicate(LogicDevice *keep, LogicDevice *remove) {
+            for(int i = 0; i < keep->outputPorts.size(); i++) {
+                Signal *oldNet = remove->outputPorts[i]->connectedNet;
+                PrintMessage(MSG_DEBUG, "nets ===" + oldNet->name + "=== and ===" + keep->outputPorts[i]->connectedNet->name + "=== are driven by identical devices and will be merged");
+                remove->outputPorts[i]->Disconnect();
+                oldFanout.clear();
+                GetFanoutDevices(oldNet, oldFanout);
+                oldNet->ConnectTo(keep->outputPorts[i]->connectedNet);
+                for(auto fanout : oldFanout) {
+                    QueueInputsChanged(fanout);
+                }
+            }
+            didOptimise = true;
+            design->structuralHash.Remove(remove);
+            purgeQueued[remove->optimiseIndex] = true;
+            devicesToPurge.push_back(remove->optimiseIndex);
+        }
+
+        void Optimiser::PurgeDevice(LogicDevice *dev) {
+            for(auto inp : dev->inputPorts) {
+                Signal *net = inp->connectedNet;
+                inp->Disconnect();
+                if(net != nullptr) {
+                    LogicDevice *driver = net->GetDriver();
+                    if(driver != nullptr) {
+                        QueueFanoutCheck(driver);
+                    }
+                }
+            }
+            for(auto outp : dev->outputPorts) {
+                outp->Disconnect();
+            }
+        }
+
+        void Optimiser::GetFanoutDevices(Signal *sig, vector<LogicDevice*> &fanout) {
+            for(auto port : sig->fanout) {
+                DeviceInputPort *dip = dynamic_cast<DeviceInputPort*>(port);
+                if(dip != nullptr) {
+                    fanout.push_back(dip->device);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <functional>
+#include "LogicDevice.hpp"
+#include "Signal.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    class LogicDesign;
+    /*
+    Worklist driven netlist optimiser
+    Rather than repeatedly sweeping over every device until nothing changes, only devices affected by a change are
+    revisited. Each pass runs device optimisations in device order, then fanout checks, then duplicate removal using
+    the design's structural hash table, then purging of removed devices
+    */
+    class Optimiser {
+    public:
+      Optimiser(LogicDesign *_design);
+      //Optimise the design until no more optimisations are possible
+      void Run();
+    private:
+      enum OptimiserPhase {
+        PHASE_OPTIMISE,
+        PHASE_FANOUT,
+        PHASE_DUPLICATES,
+        PHASE_PURGE
+      };
+      typedef priority_queue<int, vector<int>, greater<int>> IndexQueue;
+
+      LogicDesign *design;
+      OptimiserPhase phase = PHASE_OPTIMISE;
+      int position = -1; //index of the device or signal currently being processed
+      bool didOptimise = false; //set when anything was optimised in the current pass
+
+      vector<LogicDevice*> deviceByIndex;
+      //Per-device state, indexed by LogicDevice::optimiseIndex
+      vector<bool> optimiseQueued, fanoutQueued, rehashQueued, purgeQueued;
+
+      IndexQueue optimiseThisPass, optimiseNextPass;
+      IndexQueue rehashThisPass, rehashNextPass;
+      vector<int> fanoutCandidates;
+      vector<int> devicesToPurge;
+
+      //Scratch lists used to record the neighbourhood of a device before it is optimised
+      vector<Signal*> oldNets;
+      vector<LogicDevice*> oldFanout;
+
+      //Give an index to any devices added to the design since the last call, and queue them to be looked at
+      void IndexNewDevices();
+      void QueueOptimise(LogicDevice *dev);
+      void QueueFanoutCheck(LogicDevice *dev);
+      //Queue a device to be reinserted into the structural hash table, merging it with any equivalent device
+      void QueueRehash(LogicDevice *dev);
+      //Queue a device to be optimised and rehashed after its inputs have been changed
+      void QueueInputsChanged(LogicDevice *dev);
+      //Queue checks on everything affected by a device having been modified
+      void DeviceChanged(LogicDevice *dev);
+
+      bool HasFanout(LogicDevice *dev);
+      void Rehash(LogicDevice *dev);
+      void MergeDuplicate(LogicDevice *keep, LogicDevice *remove);
+      void PurgeDevice(LogicDevice *dev);
+
+      //Add the devices with an input connected to a signal to a list
+      static void GetFanoutDevices(Signal *sig, vector<LogicDevice*> &fanout);
+    };
+  }
+}
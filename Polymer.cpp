@@ -3,16 +3,101 @@
 #include <fstream>
 #include <iterator>
 #include <string>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
 #include "LogicDesign.hpp"
 #include "Util.hpp"
 using namespace std;
 using namespace SynthFramework::Polymer;
 using namespace SynthFramework;
 
+//Save a checkpoint of the design, if a filename has been given for that phase
+void SaveCheckpoint(LogicDesign *des, string filename, DesignPhase phase) {
+    if(filename == "")
+        return;
+    if(des->SaveNetlist(filename, phase)) {
+        PrintMessage(MSG_NOTE, "saved design to " + filename);
+    } else {
+        PrintMessage(MSG_ERROR, "failed to save design to " + filename);
+    }
+}
+
+//Parse the frequencies to explore, either a list such as 100e6,150e6,200e6 or a range such as 100e6:200e6:5 giving
+//the lowest and highest frequency and the number of evenly spaced frequencies. Returns false if invalid
+bool ParseFrequencies(string spec, vector<double> &frequencies) {
+    frequencies.clear();
+    if(spec.find(':') != string::npos) {
+        size_t first = spec.find(':'), second = spec.find(':', first + 1);
+        if(second == string::npos)
+            return false;
+        double low = atof(spec.substr(0, first).c_str());
+        double high = atof(spec.substr(first + 1, second - first - 1).c_str());
+        int steps = atoi(spec.substr(second + 1).c_str());
+        if((low <= 0) || (high < low) || (steps < 1) || ((steps == 1) && (high != low)))
+            return false;
+        for(int i = 0; i < steps; i++) {
+            frequencies.push_back((steps == 1) ? low : (low + (high - low) * i / (steps - 1)));
+        }
+    } else {
+        stringstream ss(spec);
+        string item;
+        while(getline(ss, item, ',')) {
+            double frequency = atof(item.c_str());
+            if(frequency <= 0)
+                return false;
+            frequencies.push_back(frequency);
+        }
+    }
+    return !frequencies.empty();
+}
+
+//Describe the points on the Pareto front found by exploring target frequencies
+string DescribeParetoFront(const vector<ExplorationPoint> &points) {
+    int frontSize = 0;
+    for(auto &point : points) {
+        if(point.pareto)
+            frontSize++;
+    }
+    ostringstream out;
+    out << "Pareto front of " << frontSize << " of " << points.size() << " target frequencies explored" << endl;
+    out << " point  target MHz  achievable MHz  latency       LUT        FF";
+    out << fixed << setprecision(2);
+    for(int i = 0; i < points.size(); i++) {
+        const ExplorationPoint &point = points[i];
+        if(!point.pareto)
+            continue;
+        out << endl << setw(6) << i << setw(12) << (point.frequency / 1e6);
+        if(std::isinf(point.achievableFrequency)) {
+            out << setw(16) << "unlimited";
+        } else {
+            out << setw(16) << (point.achievableFrequency / 1e6);
+        }
+        out << setw(9) << point.latency << setw(10) << point.lutCount << setw(10) << point.ffCount;
+    }
+    return out.str();
+}
+
 void PrintUsage(char *xname) {
     cerr << "Usage:" << endl << xname << " [options] file" << endl;
     cerr << "Valid options:" << endl;
     cerr << "\t-v : enable debug output" << endl;
+    cerr << "\t--cache=dir : reuse optimised netlists saved in a directory by earlier runs" << endl;
+    cerr << "\t--save-loaded=file : save the design as a binary netlist before synthesis" << endl;
+    cerr << "\t--save-synthesised=file : save the design as a binary netlist after synthesis" << endl;
+    cerr << "\t--save-pipelined=file : save the design as a binary netlist after pipelining" << endl;
+    cerr << "\t--resume : the input file is a binary netlist, and the flow continues from where it was saved" << endl;
+    cerr << "\t--frequency=hz : override the target frequency of the design" << endl;
+    cerr << "\t--min-registers : assign pipeline latencies to use as few registers as possible, even if the latency changes" << endl;
+    cerr << "\t--no-shift-registers : keep chains of registers as flip flops instead of using shift register resources" << endl;
+    cerr << "\t--retime : move pipeline registers across LUTs after pipelining to reduce their number" << endl;
+    cerr << "\t--timing-threads=n : analyse timing of large designs using n threads, or all hardware threads if 0" << endl;
+    cerr << "\t--report-paths=n : report the n worst paths after pipelining" << endl;
+    cerr << "\t--timing-model=file : use the delays in a timing model file in place of the built in ones" << endl;
+    cerr << "\t--timing-corner=name:file : also analyse timing at a corner with the delays in a timing model file, pipelining to meet timing at every corner" << endl;
+    cerr << "\t--explore=f1,f2,... or --explore=low:high:n : pipeline for each target frequency in parallel, or n evenly spaced ones, and report the Pareto front of achievable frequency, latency, LUTs and FFs" << endl;
+    cerr << "\t--explore-select=point : after exploring, pipeline for the target frequency of a point and write the design out as usual" << endl;
+    cerr << "\t--timing-report=file : write the worst paths to a file instead of printing them (10 unless --report-paths is given)" << endl;
     exit(EXIT_FAILURE);
 }
 
@@ -28,12 +113,79 @@ int main(int argc, char *argv[]) {
     }
     int argCount = 0;
     string inFileName;
+    string cacheDirectory = "";
+    string checkpointFile[3];
+    bool resume = false;
+    bool retime = false;
+    bool minRegisters = false;
+    bool noShiftRegisters = false;
+    double targetFrequency = 0;
+    int timingThreads = 1;
+    int reportPaths = 0;
+    string timingReportFile = "";
+    string timingModelFile = "";
+    vector<pair<string, string>> timingCorners;
+    vector<double> exploreFrequencies;
+    int exploreSelect = -1;
     for(int i = 1; i < argc; i++) {
         if(argv[i][0] == '-') {
             if(argv[i][1] == 'v') {
                 verbosity = MSG_DEBUG;
             } else if(argv[i][1] == '-') {
-                //todo: more arguments
+                string arg = argv[i];
+                if(arg.substr(0, 8) == "--cache=") {
+                    cacheDirectory = arg.substr(8);
+                } else if(arg.substr(0, 14) == "--save-loaded=") {
+                    checkpointFile[DESIGN_LOADED] = arg.substr(14);
+                } else if(arg.substr(0, 19) == "--save-synthesised=") {
+                    checkpointFile[DESIGN_SYNTHESISED] = arg.substr(19);
+                } else if(arg.substr(0, 17) == "--save-pipelined=") {
+                    checkpointFile[DESIGN_PIPELINED] = arg.substr(17);
+                } else if(arg == "--resume") {
+                    resume = true;
+                } else if(arg == "--retime") {
+                    retime = true;
+                } else if(arg == "--min-registers") {
+                    minRegisters = true;
+                } else if(arg == "--no-shift-registers") {
+                    noShiftRegisters = true;
+                } else if(arg.substr(0, 15) == "--report-paths=") {
+                    reportPaths = atoi(arg.substr(15).c_str());
+                    if(reportPaths <= 0) {
+                        PrintUsage(argv[0]);
+                    }
+                } else if(arg.substr(0, 15) == "--timing-model=") {
+                    timingModelFile = arg.substr(15);
+                } else if(arg.substr(0, 16) == "--timing-corner=") {
+                    size_t colon = arg.find(':', 16);
+                    if((colon == string::npos) || (colon == 16)) {
+                        PrintUsage(argv[0]);
+                    }
+                    timingCorners.push_back(make_pair(arg.substr(16, colon - 16), arg.substr(colon + 1)));
+                } else if(arg.substr(0, 16) == "--timing-report=") {
+                    timingReportFile = arg.substr(16);
+                } else if(arg.substr(0, 17) == "--timing-threads=") {
+                    timingThreads = atoi(arg.substr(17).c_str());
+                    if(timingThreads < 0) {
+                        PrintUsage(argv[0]);
+                    }
+                } else if(arg.substr(0, 10) == "--explore=") {
+                    if(!ParseFrequencies(arg.substr(10), exploreFrequencies)) {
+                        PrintUsage(argv[0]);
+                    }
+                } else if(arg.substr(0, 17) == "--explore-select=") {
+                    exploreSelect = atoi(arg.substr(17).c_str());
+                    if(exploreSelect < 0) {
+                        PrintUsage(argv[0]);
+                    }
+                } else if(arg.substr(0, 12) == "--frequency=") {
+                    targetFrequency = atof(arg.substr(12).c_str());
+                    if(targetFrequency <= 0) {
+                        PrintUsage(argv[0]);
+                    }
+                } else {
+                    PrintUsage(argv[0]);
+                }
             } else {
                 PrintUsage(argv[0]);
             }
@@ -45,12 +197,11 @@ int main(int argc, char *argv[]) {
         }
 
     }
-    if(argCount != 1)
+    if((argCount != 1) || ((exploreSelect >= 0) && exploreFrequencies.empty()))
         PrintUsage(argv[0]);
 
     LogicDesign *des = new LogicDesign();
 
-    ifstream codein(inFileName);
     string entname = inFileName;
     string folder = "";
     //extract filename to use as entity name
@@ -71,20 +222,82 @@ int main(int argc, char *argv[]) {
     clock_t start = clock();
 
     des->designName = entname;
+    des->cacheDirectory = cacheDirectory;
+    des->timingThreads = timingThreads;
+    des->timingReportPaths = ((reportPaths == 0) && (timingReportFile != "")) ? 10 : reportPaths;
+    des->timingReportFile = timingReportFile;
     //des->technology = new Artix7Technology();
-    des->LoadDesign(string((istreambuf_iterator<char>(codein)), istreambuf_iterator<char>()));
-    des->SynthesiseAndOptimiseDesign();
-    des->AnalyseTiming();
-    des->PipelineDesign();
+    DesignPhase phase = DESIGN_LOADED;
+    if(resume) {
+        if(!des->LoadNetlist(inFileName, phase)) {
+            PrintMessage(MSG_ERROR, "failed to load binary netlist " + inFileName);
+        }
+        PrintMessage(MSG_NOTE, "resumed design " + des->designName + " with " + to_string(des->devices.size()) + " devices");
+    } else if(!des->LoadDesignFile(inFileName)) {
+        PrintMessage(MSG_ERROR, "failed to open " + inFileName);
+    }
+    if(targetFrequency > 0) {
+        des->targetFrequency = targetFrequency;
+    }
+    if(retime) {
+        des->allowRetime = true;
+    }
+    if(minRegisters) {
+        des->minimiseRegisters = true;
+    }
+    if(noShiftRegisters) {
+        des->allowShiftRegisters = false;
+    }
+    if((timingModelFile != "") && !des->technology->LoadTimingModel(timingModelFile)) {
+        PrintMessage(MSG_ERROR, "failed to open timing model " + timingModelFile);
+    }
+    for(auto &corner : timingCorners) {
+        if(!des->technology->AddCorner(corner.first, corner.second)) {
+            PrintMessage(MSG_ERROR, "failed to open timing model " + corner.second);
+        }
+    }
+    //A checkpoint can't be saved for a phase a resumed design has already passed, as the netlist it held would be
+    //labelled with the wrong phase
+    for(int p = DESIGN_LOADED; p < phase; p++) {
+        if(checkpointFile[p] != "") {
+            PrintMessage(MSG_ERROR, "can't save design to " + checkpointFile[p] + ", as it was resumed from a later phase");
+        }
+    }
+    SaveCheckpoint(des, checkpointFile[phase], phase);
+    if(phase < DESIGN_SYNTHESISED) {
+        des->SynthesiseAndOptimiseDesign();
+        SaveCheckpoint(des, checkpointFile[DESIGN_SYNTHESISED], DESIGN_SYNTHESISED);
+    }
+    if(!exploreFrequencies.empty()) {
+        if(phase >= DESIGN_PIPELINED) {
+            PrintMessage(MSG_ERROR, "can't explore target frequencies of a design that is already pipelined");
+        }
+        vector<ExplorationPoint> points = des->ExploreFrequencies(exploreFrequencies);
+        PrintMessage(MSG_NOTE, DescribeParetoFront(points));
+        if(exploreSelect < 0) {
+            delete des;
+            return 0;
+        }
+        if(exploreSelect >= points.size()) {
+            PrintMessage(MSG_ERROR, "no explored point " + to_string(exploreSelect));
+        }
+        des->targetFrequency = points[exploreSelect].frequency;
+        PrintMessage(MSG_NOTE, "pipelining for explored point " + to_string(exploreSelect));
+    }
+    if(phase < DESIGN_PIPELINED) {
+        des->PipelineDesign();
+        SaveCheckpoint(des, checkpointFile[DESIGN_PIPELINED], DESIGN_PIPELINED);
+    }
     des->AnalysePostPipelineTiming();
 
     PrintMessage(MSG_NOTE, des->technology->PrintResourceUsage(des));
 
-    ofstream vhdlout(string(argv[1]) + ".vhd");
+    ofstream vhdlout(inFileName + ".vhd");
     vhdlout << des->GenerateVHDL();
     double time = ((double)(clock() - start)) / CLOCKS_PER_SEC;
 
     PrintMessage(MSG_NOTE, "total synthesis time was " + to_string(time) + " seconds");
 
+    delete des;
     return 0;
 }
@@ -0,0 +1,498 @@
+#include "Retimer.hpp"
+#include "LogicDesign.hpp"
+#include "Util.hpp"
+#include <algorithm>
+#include <limits>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        Retimer::Retimer(LogicDesign *_design, bool _assignLatency) {
+            design = _design;
+            assignLatency = _assignLatency;
+        }
+
+        bool Retimer::IsIgnoredNet(Signal *net) {
+            bool value;
+            return (net == design->clockSignal) || net->isSlow || net->GetConstantValue(value);
+        }
+
+        bool Retimer::IsChainRegister(LogicDevice *dev) {
+            FlipFlop *ff = DeviceCast<FlipFlop>(dev);
+            return (ff != nullptr) && !ff->isShift && !ff->hasEnable && !ff->hasReset &&
+                (ff->inputPorts[1]->connectedNet == design->clockSignal) && !IsIgnoredNet(ff->inputPorts[0]->connectedNet);
+        }
+
+        bool Retimer::IsRetimable(LogicDevice *dev) {
+            if(dev->kind == DEVICE_LUT) {
+                return !dev->outputPorts[0]->connectedNet->isSlow;
+            }
+            //Vendor specific devices can be retimed if every output depends on the inputs within the same cycle
+            VendorSpecificDevice *vsd = DeviceCast<VendorSpecificDevice>(dev);
+            if(vsd == nullptr)
+                return false;
+            for(int j = 0; j < int(vsd->outputPorts.size()); j++) {
+                bool hasArc = false;
+                for(int i = 0; (i < int(vsd->inputPorts.size())) && !hasArc; i++) {
+                    double routingDelay, cellDelay;
+                    hasArc = design->technology->GetTimingArc(vsd, i, j, 0, routingDelay, cellDelay);
+                }
+                if(!hasArc)
+                    return false;
+            }
+            return true;
+        }
+
+        int Retimer::GetVertex(LogicDevice *dev) {
+            auto vertex = vertexIds.find(dev);
+            return (vertex != vertexIds.end()) ? vertex->second : 0;
+        }
+
+        int Retimer::GetInputVertex(DesignInputPort *port) {
+            if(!assignLatency || (port->latcon == nullptr))
+                return 0;
+            return latconVertex[port->latcon];
+        }
+
+        int Retimer::GetOutputVertex(DesignOutputPort *port) {
+            if(!assignLatency)
+                return 0;
+            if(port->latcons.empty())
+                return outputVertex;
+            return latconVertex[port->latcons.front()];
+        }
+
+        int Retimer::GetLatencyChange(DesignOutputPort *port) {
+            return solution.empty() ? 0 : solution[GetOutputVertex(port)];
+        }
+
+        void Retimer::TraceNet(int driver, Signal *net) {
+            if(IsIgnoredNet(net))
+                return;
+            int netIndex = nets.size();
+            nets.push_back(net);
+            netDriver.push_back(driver);
+            netFanout.push_back(0);
+            vector<pair<Signal*, int>> pending;
+            pending.push_back(make_pair(net, 0));
+            while(!pending.empty()) {
+                Signal *sig = pending.back().first;
+                int depth = pending.back().second;
+                pending.pop_back();
+                for(auto port : sig->fanout) {
+                    Edge edge = {netIndex, 0, port, depth, false};
+                    if(DeviceInputPort *dip = dynamic_cast<DeviceInputPort*>(port)) {
+                        if((registerSet.find(dip->device) != registerSet.end()) && (dip->pin == 0)) {
+                            registers.push_back(dip->device);
+                            pending.push_back(make_pair(dip->device->outputPorts[0]->connectedNet, depth + 1));
+                            continue;
+                        }
+                        edge.to = GetVertex(dip->device);
+                        //Registers mustn't be added to or removed from the clock, enable or reset of a flip flop
+                        edge.fixed = (dip->device->kind == DEVICE_FLIPFLOP) && (dip->pin != 0);
+                    } else if(DesignOutputPort *dop = dynamic_cast<DesignOutputPort*>(port)) {
+                        edge.to = GetOutputVertex(dop);
+                    } else {
+                        netFanout[netIndex]++;
+                        continue;
+                    }
+                    netFanout[netIndex]++;
+                    edgeBySink[port] = edges.size();
+                    edges.push_back(edge);
+                }
+            }
+        }
+
+        void Retimer::BuildGraph() {
+            vertices.push_back(nullptr);
+            //When assigning latency, the outputs and the outputs of each latency constraint may all be delayed, along
+            //with the inputs whose latency depends on them
+            if(assignLatency) {
+                outputVertex = vertices.size();
+                vertices.push_back(nullptr);
+                for(auto latcon : design->latcons) {
+                    latconVertex[latcon] = vertices.size();
+                    vertices.push_back(nullptr);
+                }
+            }
+            for(auto dev : design->devices) {
+                if(IsChainRegister(dev)) {
+                    registerSet.insert(dev);
+                } else if(IsRetimable(dev)) {
+                    vertexIds[dev] = vertices.size();
+                    vertices.push_back(dev);
+                }
+            }
+            for(auto inp : design->inputPorts) {
+                TraceNet(GetInputVertex(inp), inp->connectedNet);
+            }
+            for(auto dev : design->devices) {
+                if(registerSet.find(dev) == registerSet.end()) {
+                    for(auto outp : dev->outputPorts) {
+                        TraceNet(GetVertex(dev), outp->connectedNet);
+                    }
+                }
+            }
+            //Registers not reached from any device form loops on their own, and are left as they are
+            unordered_set<LogicDevice*> reached(registers.begin(), registers.end());
+            for(auto dev : design->devices) {
+                if((registerSet.find(dev) != registerSet.end()) && (reached.find(dev) == reached.end())) {
+                    registerSet.erase(dev);
+                    size_t first = registers.size();
+                    TraceNet(0, dev->outputPorts[0]->connectedNet);
+                    reached.insert(registers.begin() + first, registers.end());
+                }
+            }
+        }
+
+        DifferenceConstraints Retimer::CreateProblem() {
+            //No retiming needs to move more registers than there are
+            DifferenceConstraints problem(vertices.size() + nets.size(), registers.size() + 1);
+            for(auto &edge : edges) {
+                int from = netDriver[edge.net], netVar = vertices.size() + edge.net;
+                //The edge keeps a weight of at least 0, or the same weight if it is fixed
+                problem.AddConstraint(from, edge.to, edge.weight);
+                if(edge.fixed) {
+                    problem.AddConstraint(edge.to, from, -edge.weight);
+                }
+                //The registers after the net must be at least the weight of each edge
+                problem.AddConstraint(edge.to, netVar, -edge.weight);
+            }
+            for(int n = 0; n < int(nets.size()); n++) {
+                //A net can't have fewer than no registers after it
+                problem.AddConstraint(netDriver[n], vertices.size() + n, 0);
+                problem.AddWeight(vertices.size() + n, 1);
+                problem.AddWeight(netDriver[n], -1);
+            }
+            //Outputs belonging to more than one latency constraint tie their latencies together
+            for(auto outp : design->outputPorts) {
+                for(int i = 1; assignLatency && (i < int(outp->latcons.size())); i++) {
+                    int a = latconVertex[outp->latcons.front()], b = latconVertex[outp->latcons[i]];
+                    problem.AddConstraint(a, b, 0);
+                    problem.AddConstraint(b, a, 0);
+                }
+            }
+            //The latency of each output is kept within the latency limits of the design, without making one already
+            //outside them any worse
+            for(auto outp : design->outputPorts) {
+                if(assignLatency) {
+                    int v = GetOutputVertex(outp), latency = outp->connectedNet->latency;
+                    if(design->maxLatency >= 0) {
+                        problem.AddConstraint(v, 0, max(design->maxLatency - latency, 0));
+                    }
+                    problem.AddConstraint(0, v, max(latency - design->minLatency, 0));
+                }
+            }
+            return problem;
+        }
+
+        int Retimer::CountRegisters(const vector<int64_t> &values) {
+            int64_t count = 0;
+            for(int n = 0; n < int(nets.size()); n++) {
+                count += values[vertices.size() + n] - values[netDriver[n]];
+            }
+            return count;
+        }
+
+        void Retimer::Rebuild(const vector<int64_t> &values) {
+            for(auto reg : registers) {
+                reg->RemoveDevice();
+            }
+            design->devices.erase(remove_if(design->devices.begin(), design->devices.end(), [this](LogicDevice *dev) {
+                return registerSet.find(dev) != registerSet.end();
+            }), design->devices.end());
+            for(auto reg : registers) {
+                design->DestroyDevice(reg);
+            }
+            registers.clear();
+            registerSet.clear();
+            for(auto sig : design->signals) {
+                sig->pipelined = nullptr;
+            }
+            //Each net gets a single chain of registers, with each input connected at the depth it needs
+            size_t firstNew = design->devices.size();
+            for(auto &edge : edges) {
+                int weight = edge.weight + values[edge.to] - values[netDriver[edge.net]];
+                Signal *sig = nets[edge.net];
+                for(int i = 0; i < weight; i++) {
+                    sig = design->PipelineSignal(sig);
+                }
+                edge.sink->Disconnect();
+                edge.sink->Connect(sig);
+            }
+            for(auto sig : design->signals) {
+                sig->pipelined = nullptr;
+            }
+            registers.assign(design->devices.begin() + firstNew, design->devices.end());
+            registerSet.insert(registers.begin(), registers.end());
+        }
+
+        bool Retimer::GetEdgeDelay(int edge, int output, int corner, bool registered, double &delay) {
+            DeviceTechnology *technology = design->technology;
+            DeviceInputPort *inp = static_cast<DeviceInputPort*>(edges[edge].sink);
+            LogicDevice *driver = nets[edges[edge].net]->GetDriver();
+            bool lutDriven = !registered && (driver != nullptr) && (driver->kind == DEVICE_LUT);
+            int fanout = registered ? 1 : netFanout[edges[edge].net];
+            if(inp->device->kind == DEVICE_LUT) {
+                delay = technology->GetRoutingDelay(lutDriven, fanout, corner) + technology->GetLUTPinDelay(static_cast<LUT*>(inp->device), inp->pin, corner);
+                return true;
+            }
+            double routingDelay, cellDelay;
+            if(!technology->GetTimingArc(static_cast<VendorSpecificDevice*>(inp->device), inp->pin, output, corner, lutDriven, fanout, routingDelay, cellDelay))
+                return false;
+            delay = routingDelay + cellDelay;
+            return true;
+        }
+
+        void Retimer::AddPathConstraints(DifferenceConstraints &problem) {
+            DeviceTechnology *technology = design->technology;
+            //Output of the device driving each net, for nets driven by a vertex with a device
+            vector<int> netOutput(nets.size(), -1);
+            for(int n = 0; n < int(nets.size()); n++) {
+                LogicDevice *dev = vertices[netDriver[n]];
+                if(dev != nullptr) {
+                    netOutput[n] = find(dev->outputPorts.begin(), dev->outputPorts.end(), nets[n]->driver) - dev->outputPorts.begin();
+                }
+            }
+            //For the output being searched back from, the fewest original registers on a path to it from each net and
+            //the greatest delay of such a path, valid for nets marked with the current search
+            vector<int> pathWeight(nets.size()), searchMark(nets.size(), -1);
+            vector<double> pathDelay(nets.size());
+            //Strongest bound found on the retiming of each vertex a path starts from, relative to the output
+            vector<int64_t> startBound(vertices.size());
+            vector<int> startMark(vertices.size(), -1), starts, pending;
+            //Edges that must keep no registers
+            vector<bool> keptOff(edges.size(), false);
+            int search = 0;
+            for(int c = 0; c < technology->GetCornerCount(); c++) {
+                double budget = design->GetPipelineBudget(c), clockToOut = technology->GetClockToOutDelay(c);
+                auto addStart = [&](int u, int bound) {
+                    if(startMark[u] != search) {
+                        startMark[u] = search;
+                        startBound[u] = bound;
+                        starts.push_back(u);
+                    } else {
+                        startBound[u] = min(startBound[u], int64_t(bound));
+                    }
+                };
+                //Follow paths back through the inputs of a device, given the registers and delay from the output
+                auto visitDevice = [&](int u, int output, int weight, double delay) {
+                    LogicDevice *dev = vertices[u];
+                    for(int i = 0; i < int(dev->inputPorts.size()); i++) {
+                        auto found = edgeBySink.find(dev->inputPorts[i]);
+                        double startDelay, edgeDelay;
+                        if((found == edgeBySink.end()) || !GetEdgeDelay(found->second, output, c, true, startDelay))
+                            continue;
+                        const Edge &edge = edges[found->second];
+                        GetEdgeDelay(found->second, output, c, false, edgeDelay);
+                        //A path starting from a register on this input would miss the budget, so there must be a register
+                        //after the device. If there wasn't one before retiming, the input is kept free of registers
+                        //instead, and paths further back must then be followed too
+                        if((clockToOut + startDelay + delay) >= budget) {
+                            if(weight > 0) {
+                                addStart(u, weight - 1);
+                                continue;
+                            }
+                            if(edge.weight == 0) {
+                                keptOff[found->second] = true;
+                            }
+                        }
+                        int nextWeight = weight + edge.weight;
+                        double nextDelay = delay + edgeDelay;
+                        //A path without registers that misses the budget whatever it starts from already missed it
+                        //before retiming, unless the delay estimate is out
+                        if((nextWeight == 0) && (nextDelay >= budget))
+                            continue;
+                        if((searchMark[edge.net] != search) || (nextWeight < pathWeight[edge.net]) ||
+                                ((nextWeight == pathWeight[edge.net]) && (nextDelay > pathDelay[edge.net]))) {
+                            searchMark[edge.net] = search;
+                            pathWeight[edge.net] = nextWeight;
+                            pathDelay[edge.net] = nextDelay;
+                            pending.push_back(edge.net);
+                        }
+                    }
+                };
+                for(int v = 1; v < int(vertices.size()); v++) {
+                    if(vertices[v] == nullptr)
+                        continue;
+                    for(int j = 0; j < int(vertices[v]->outputPorts.size()); j++) {
+                        if(failing.find(vertices[v]->outputPorts[j]->connectedNet) != failing.end())
+                            continue;
+                        search++;
+                        starts.clear();
+                        visitDevice(v, j, 0, 0);
+                        while(!pending.empty()) {
+                            int n = pending.back();
+                            pending.pop_back();
+                            if(vertices[netDriver[n]] != nullptr) {
+                                visitDevice(netDriver[n], netOutput[n], pathWeight[n], pathDelay[n]);
+                            } else if((pathWeight[n] > 0) && ((nets[n]->delay[c] + pathDelay[n]) >= budget)) {
+                                //Paths from the top level IO or a device that can't be retimed start with the delay
+                                //of the net
+                                addStart(netDriver[n], pathWeight[n] - 1);
+                            }
+                        }
+                        for(auto u : starts) {
+                            problem.AddConstraint(u, v, startBound[u]);
+                        }
+                    }
+                }
+            }
+            for(int e = 0; e < int(edges.size()); e++) {
+                if(keptOff[e]) {
+                    problem.AddConstraint(edges[e].to, netDriver[edges[e].net], 0);
+                }
+            }
+        }
+
+        int Retimer::AddTimingConstraints(DifferenceConstraints &problem) {
+            DeviceTechnology *technology = design->technology;
+            int added = 0;
+            for(int v = 1; v < int(vertices.size()); v++) {
+                if(vertices[v] == nullptr)
+                    continue;
+                for(int j = 0; j < int(vertices[v]->outputPorts.size()); j++) {
+                    //Find the corner where the output misses the budget by the most
+                    Signal *net = vertices[v]->outputPorts[j]->connectedNet;
+                    int corner = 0;
+                    double worstExcess = -numeric_limits<double>::infinity();
+                    for(int c = 0; c < technology->GetCornerCount(); c++) {
+                        double excess = net->delay[c] - design->GetPipelineBudget(c);
+                        if(excess > worstExcess) {
+                            corner = c;
+                            worstExcess = excess;
+                        }
+                    }
+                    if((worstExcess < 0) || (failing.find(net) != failing.end()))
+                        continue;
+                    //Follow the inputs setting the delay back through devices connected without registers, recording
+                    //the arrival time at the start of the path from each device, and the original registers after it
+                    LogicDevice *dev = vertices[v];
+                    int first = v, output = j, pathWeight = 0, startEdge = -1;
+                    vector<pair<int, int>> path;
+                    vector<double> pathStart;
+                    while(vertices[first] != nullptr) {
+                        int worstInput = -1;
+                        double worstArrival = -numeric_limits<double>::infinity();
+                        for(int i = 0; i < int(dev->inputPorts.size()); i++) {
+                            Signal *in = dev->inputPorts[i]->connectedNet;
+                            double routingDelay, cellDelay;
+                            bool hasArc = true;
+                            if(dev->kind == DEVICE_LUT) {
+                                routingDelay = technology->GetRoutingDelay(in, corner);
+                                cellDelay = technology->GetLUTPinDelay(static_cast<LUT*>(dev), i, corner);
+                            } else {
+                                hasArc = technology->GetTimingArc(static_cast<VendorSpecificDevice*>(dev), i, output, corner, routingDelay, cellDelay);
+                            }
+                            if(hasArc && ((in->delay[corner] + routingDelay + cellDelay) > worstArrival)) {
+                                worstArrival = in->delay[corner] + routingDelay + cellDelay;
+                                worstInput = i;
+                            }
+                        }
+                        if(worstInput == -1)
+                            break;
+                        DeviceInputPort *inp = dev->inputPorts[worstInput];
+                        path.push_back(make_pair(first, pathWeight));
+                        pathStart.push_back(inp->connectedNet->delay[corner]);
+                        auto edge = edgeBySink.find(inp);
+                        if(edge == edgeBySink.end())
+                            break;
+                        //The path starts at a register if the input isn't connected to the net directly
+                        if(inp->connectedNet != nets[edges[edge->second].net]) {
+                            startEdge = edge->second;
+                            break;
+                        }
+                        //Paths starting from the top level IO or a device that can't be retimed end at a vertex with no
+                        //device
+                        pathWeight += edges[edge->second].weight;
+                        first = netDriver[edges[edge->second].net];
+                        if(vertices[first] != nullptr) {
+                            dev = vertices[first];
+                            Signal *driven = nets[edges[edge->second].net];
+                            output = find(dev->outputPorts.begin(), dev->outputPorts.end(), driven->driver) - dev->outputPorts.begin();
+                        }
+                    }
+                    if(vertices[first] == nullptr) {
+                        path.push_back(make_pair(first, pathWeight));
+                    }
+                    //The shortest part of the path that misses the budget by itself is given a register, as that is the
+                    //strongest constraint needed. Parts that had no registers before retiming met the budget then, so
+                    //the delay estimate is out and the part is extended until the constraint is one the original
+                    //registers meet, keeping the problem feasible
+                    bool constrained = false;
+                    for(int k = 1; (k < int(path.size())) && !constrained; k++) {
+                        if((path[k].second > 0) && ((k == int(path.size()) - 1) || ((net->delay[corner] - pathStart[k]) >= design->GetPipelineBudget(corner)))) {
+                            problem.AddConstraint(path[k].first, v, path[k].second - 1);
+                            constrained = true;
+                        }
+                    }
+                    //Otherwise the path only misses the budget as it starts from a register that retiming moved onto
+                    //it, so the register is kept off the start of the path instead
+                    if(!constrained && (startEdge != -1) && (edges[startEdge].weight == 0)) {
+                        problem.AddConstraint(edges[startEdge].to, netDriver[edges[startEdge].net], 0);
+                        constrained = true;
+                    }
+                    if(constrained) {
+                        added++;
+                    }
+                }
+            }
+            return added;
+        }
+
+        void Retimer::Run() {
+            BuildGraph();
+            int originalCount = registers.size();
+            //Outputs that already miss the budget can't be fixed by retiming, so are left out of the timing constraints.
+            //Delays are brought up to date first, as pipelining leaves the delays from before each register was added
+            design->AnalyseTiming();
+            for(int v = 1; v < int(vertices.size()); v++) {
+                if(vertices[v] == nullptr)
+                    continue;
+                for(auto outp : vertices[v]->outputPorts) {
+                    for(int c = 0; c < design->technology->GetCornerCount(); c++) {
+                        if(outp->connectedNet->delay[c] >= design->GetPipelineBudget(c)) {
+                            failing.insert(outp->connectedNet);
+                        }
+                    }
+                }
+            }
+            DifferenceConstraints problem = CreateProblem();
+            AddPathConstraints(problem);
+            vector<int64_t> values;
+            //The first solution normally meets the budget. Any later one meets the constraints of earlier ones, and is
+            //rejected if it misses the budget, so the number of attempts is limited in case there are many paths to
+            //constrain
+            const int maxAttempts = 50;
+            bool rebuilt = false, met = false;
+            int bestCount = originalCount;
+            for(int attempt = 0; attempt < maxAttempts; attempt++) {
+                if(!problem.Solve(values))
+                    break;
+                int count = CountRegisters(values);
+                if(count >= originalCount)
+                    break;
+                Rebuild(values);
+                rebuilt = true;
+                design->AnalyseTiming();
+                if(AddTimingConstraints(problem) == 0) {
+                    met = true;
+                    bestCount = count;
+                    break;
+                }
+            }
+            string pass = assignLatency ? "latency assignment" : "retiming";
+            if(met) {
+                solution = values;
+                PrintMessage(MSG_NOTE, pass + " reduced pipeline registers from " + to_string(originalCount) + " to " + to_string(bestCount));
+            } else {
+                if(rebuilt) {
+                    values.assign(problem.GetVariableCount(), 0);
+                    Rebuild(values);
+                    design->AnalyseTiming();
+                }
+                PrintMessage(MSG_NOTE, pass + " found no way to use fewer than " + to_string(originalCount) + " pipeline registers");
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "LogicDevice.hpp"
+#include "BasicDevices.hpp"
+#include "Signal.hpp"
+#include "DifferenceConstraints.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    class LogicDesign;
+    class DesignInputPort;
+    class DesignOutputPort;
+    class LatencyConstraint;
+    /*
+    Leiserson-Saxe retiming of a pipelined design, moving registers across LUTs and combinational vendor devices so
+    that as few registers as possible are used while still meeting the timing budget used for pipelining
+
+    The design is treated as a graph with an edge from each device driving a net to each input the net reaches, weighted
+    by the number of registers in between. Retiming a device by r moves r registers from its outputs to its inputs,
+    changing the weight of an edge from u to v to w + r(v) - r(u). Registers on edges from the same net are shared, so
+    a net needs as many registers as its edge of greatest weight. The top level IO and devices that can't be retimed,
+    such as registers with enables or resets, shift registers and registered vendor devices, all keep r = 0. This keeps
+    the latency between any two of them, and so the latency of outputs and latency constraints, unchanged
+
+    Finding the retiming using the fewest registers is a difference constraint problem. Timing is constrained up front
+    as in Leiserson and Saxe: searching back from each device output, a path starting at a device is given a register
+    if it would miss the budget when the device is fed from a register. The routing delay of a net is taken at the
+    greatest fanout it can have, so the constraints hold whatever retiming is chosen. Where the path had no register
+    before retiming, it only met the budget as it starts earlier than a register would, and the register is kept off
+    its start instead. A single solve then meets the budget, except where the delay depends on a device that can't be
+    retimed. The design is rebuilt and its timing analysed to check, and any device output still missing the budget is
+    constrained as well and the problem solved again
+
+    Minimum register pipelining uses the same problem to assign latencies, starting from the latencies found by the
+    greedy pipeliner, which are known to meet the budget. The outputs, and the outputs of each latency constraint, are
+    then also given a retiming value, which changes their latency. Top level inputs whose latency depends on a latency
+    constraint are moved along with its outputs, so the constraint still holds, and outputs not covered by one keep the
+    same latency as each other
+    */
+    class Retimer {
+    public:
+      //If assignLatency is set, the latency of the outputs may change as well
+      Retimer(LogicDesign *_design, bool _assignLatency = false);
+      //Retime the design. The original registers are kept if no retiming meeting the budget uses fewer of them
+      void Run();
+      //Return the number of cycles the latency of an output changed by
+      int GetLatencyChange(DesignOutputPort *port);
+    private:
+      LogicDesign *design;
+      bool assignLatency;
+      vector<int64_t> solution; //retiming values chosen, empty if the original registers were kept
+
+      //Devices registers can be moved across, numbered from 1. Vertex 0 stands for the top level IO and every device
+      //that can't be retimed. When assigning latency, the outputs and each latency constraint have a vertex too,
+      //which has no device
+      vector<LogicDevice*> vertices;
+      unordered_map<LogicDevice*, int> vertexIds;
+      int outputVertex = 0;
+      unordered_map<LatencyConstraint*, int> latconVertex;
+      //Nets driven by a device or top level input, from which chains of registers start
+      vector<Signal*> nets;
+      vector<int> netDriver; //vertex driving each net
+      vector<int> netFanout; //greatest fanout each net can have, with every input it reaches connected to it directly
+      struct Edge {
+        int net;
+        int to; //vertex the edge goes to
+        LogicPort *sink; //input the edge ends at
+        int weight; //registers between the net and the input
+        bool fixed; //set if the weight can't change, such as for a clock or enable input
+      };
+      vector<Edge> edges;
+      unordered_map<LogicPort*, int> edgeBySink;
+      //Registers forming the chains between nets and inputs, which are removed and recreated for each retiming
+      vector<LogicDevice*> registers;
+      unordered_set<LogicDevice*> registerSet;
+      //Device outputs missing the timing budget before retiming
+      unordered_set<Signal*> failing;
+
+      //Returns true if a device can be treated as a register in a chain
+      bool IsChainRegister(LogicDevice *dev);
+      //Returns true if the registers following a net can't be changed, such as for constant or slow signals
+      bool IsIgnoredNet(Signal *net);
+      //Returns true if registers can be moved across a device
+      bool IsRetimable(LogicDevice *dev);
+      int GetVertex(LogicDevice *dev);
+      int GetInputVertex(DesignInputPort *port);
+      int GetOutputVertex(DesignOutputPort *port);
+      //Find the graph of the design
+      void BuildGraph();
+      //Add the edges from a net driven by a vertex, following any chains of registers
+      void TraceNet(int driver, Signal *net);
+      //Set up the constraints that keep edge weights valid, and the weights that count the registers needed. Retiming
+      //values of vertices are variables 1 to vertices.size(), followed by the number of registers after each net
+      DifferenceConstraints CreateProblem();
+      //Return the number of registers needed by a retiming
+      int CountRegisters(const vector<int64_t> &values);
+      //Replace the registers of the design with those needed by a retiming
+      void Rebuild(const vector<int64_t> &values);
+      //Get the delay from the net at the start of an edge through the input it ends at to an output of its device,
+      //with the routing delay of the net as if it were driven by a register or otherwise at its greatest fanout.
+      //Returns false if the output doesn't depend on the input
+      bool GetEdgeDelay(int edge, int output, int corner, bool registered, double &delay);
+      //Constrain every path starting at a device or top level input that would miss the timing budget to have a
+      //register along it
+      void AddPathConstraints(DifferenceConstraints &problem);
+      //Constrain the path to each device output that misses the timing budget to have a register, returning the number
+      //of constraints added. Paths that can't be given a register aren't constrained
+      int AddTimingConstraints(DifferenceConstraints &problem);
+    };
+  }
+}
@@ -9,54 +9,152 @@ namespace SynthFramework {
     namespace Polymer {
 
         int Signal::GetFanout() {
-            int fanout = 0;
-            for(auto port : connectedPorts) {
-                if(!port->IsDriver()) {
-                    fanout++;
+            return fanout.size();
+        }
+
+        int Signal::GetDriverCount() {
+            return ((driver != nullptr) ? 1 : 0) + extraDrivers.size();
+        }
+
+        bool Signal::IsConnected() {
+            return (driver != nullptr) || (fanout.size() > 0);
+        }
+
+        void Signal::AddPort(LogicPort *port) {
+            if(port->IsDriver()) {
+                if(driver == nullptr) {
+                    driver = port;
+                    port->netSlot = -1;
+                } else {
+                    AddToList(extraDrivers, port);
+                }
+                UpdateDriverInfo();
+            } else {
+                AddToList(fanout, port);
+            }
+        }
+
+        void Signal::RemovePort(LogicPort *port) {
+            if(port == driver) {
+                if(extraDrivers.size() > 0) {
+                    driver = extraDrivers.back();
+                    driver->netSlot = -1;
+                    extraDrivers.pop_back();
+                } else {
+                    driver = nullptr;
+                }
+                UpdateDriverInfo();
+            } else if(port->IsDriver()) {
+                RemoveFromList(extraDrivers, port);
+                UpdateDriverInfo();
+            } else {
+                RemoveFromList(fanout, port);
+            }
+        }
+
+        void Signal::AddToList(vector<LogicPort*> &list, LogicPort *port) {
+            port->netSlot = list.size();
+            list.push_back(port);
+        }
+
+        void Signal::RemoveFromList(vector<LogicPort*> &list, LogicPort *port) {
+            int slot = port->netSlot;
+            //Ignore ports which have already been disconnected
+            if((slot < 0) || (slot >= list.size()) || (list[slot] != port))
+                return;
+            //Move the last port into the gap
+            list[slot] = list.back();
+            list[slot]->netSlot = slot;
+            list.pop_back();
+            port->netSlot = -1;
+        }
+
+        void Signal::UpdateDriverInfo() {
+            driverDevice = nullptr;
+            constantState = LogicState_Unknown;
+            for(int i = -1; i < int(extraDrivers.size()); i++) {
+                LogicPort *port = (i == -1) ? driver : extraDrivers[i];
+                if(port == nullptr)
+                    continue;
+                //The first driving device and the first known constant value are used
+                if(driverDevice == nullptr) {
+                    DeviceOutputPort* devPort = dynamic_cast<DeviceOutputPort*>(port);
+                    if(devPort != nullptr) {
+                        driverDevice = devPort->device;
+                    }
+                }
+                if((constantState == LogicState_Unknown) && port->IsConstantDriver()) {
+                    constantState = port->GetConstantState();
                 }
             }
-            return fanout;
         }
 
         void Signal::ConnectTo(Signal* other) {
-            for(auto port : connectedPorts) {
-                port->connectedNet = other;
-                other->connectedPorts.push_back(port);
+            //A signal that has already been merged is represented by the signal it was merged into
+            if(mergedInto != nullptr) {
+                Resolve()->ConnectTo(other);
+                return;
+            }
+            other = other->Resolve();
+            if(other == this)
+                return;
+            //The ports keep pointing to this signal, and reach other through mergedInto. The longer fanout list is
+            //swapped into other so that only the shorter one is copied, keeping each port's slot
+            if(driver != nullptr) {
+                other->AddPort(driver);
+            }
+            for(auto port : extraDrivers) {
+                other->AddPort(port);
+            }
+            if(fanout.size() > other->fanout.size()) {
+                fanout.swap(other->fanout);
+            }
+            for(auto port : fanout) {
+                other->AddToList(other->fanout, port);
             }
             if(isSlow)
               other->isSlow = true;
-            for(auto bus : parentBuses) {
-                for(auto &sig : bus->signals) {
-                    if(sig == this) {
-                        sig = other;
-                    }
-                }
-                other->parentBuses.push_back(bus);
+            for(auto slot : parentBuses) {
+                slot.bus->signals[slot.index] = other;
+                other->parentBuses.push_back(slot);
             }
             parentBuses.clear();
-            connectedPorts.clear();
+            driver = nullptr;
+            extraDrivers.clear();
+            fanout.clear();
+            UpdateDriverInfo();
+            mergedInto = other;
         }
 
-        bool Signal::GetConstantValue(bool &val) {
-            for(auto port : connectedPorts) {
-                if(port->IsDriver() && port->IsConstantDriver()) {
-                    switch(port->GetConstantState()) {
-                    case LogicState_Unknown:
-                        break;
-                    case LogicState_Low:
-                        val = false;
-                        return true;
-                    case LogicState_High:
-                        val = true;
-                        return true;
-                    case LogicState_DontCare:
-                        val = false;
-                        return true;
-                    }
+        Signal *Signal::Resolve() {
+            Signal *root = this;
+            while(root->mergedInto != nullptr) {
+                root = root->mergedInto;
+            }
+            //Path compression, so later lookups are near constant time
+            Signal *sig = this;
+            while(sig != root) {
+                Signal *next = sig->mergedInto;
+                sig->mergedInto = root;
+                sig = next;
+            }
+            return root;
+        }
 
-                }
+        bool Signal::GetConstantValue(bool &val) {
+            switch(constantState) {
+            case LogicState_Low:
+                val = false;
+                return true;
+            case LogicState_High:
+                val = true;
+                return true;
+            case LogicState_DontCare:
+                val = false;
+                return true;
+            default:
+                return false;
             }
-            return false;
         }
 
         Bus::Bus() {
@@ -69,6 +167,20 @@ namespace SynthFramework {
             width = _width;
         }
 
+        void Bus::AddSignal(Signal *sig) {
+            BusSlot slot;
+            slot.bus = this;
+            slot.index = signals.size();
+            sig->parentBuses.push_back(slot);
+            signals.push_back(sig);
+        }
+
+        void Bus::ResolveSignals() {
+            for(auto &sig : signals) {
+                sig = sig->Resolve();
+            }
+        }
+
         bool Bus::GetConstantValue(long long &val) {
             long long val_tmp = 0;
             for(int i = 0; i < signals.size(); i++) {
@@ -94,15 +206,7 @@ namespace SynthFramework {
         }
 
         LogicDevice *Signal::GetDriver() {
-            for(auto port : connectedPorts) {
-                if(port->IsDriver()) {
-                    DeviceOutputPort* devPort = dynamic_cast<DeviceOutputPort*>(port);
-                    if(devPort != nullptr) {
-                        return devPort->device;
-                    }
-                }
-            }
-            return nullptr;
+            return driverDevice;
         }
     }
 }
@@ -2,6 +2,9 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <limits>
+#include "Arena.hpp"
+#include "LogicCore.hpp"
 using namespace std;
 
 namespace SynthFramework {
@@ -9,32 +12,71 @@ namespace SynthFramework {
      class LogicPort;
      class Bus;
      class LogicDevice;
+     //Maximum number of delay corners timing can be analysed at
+     const int MaxTimingCorners = 4;
+     //The position of a signal within a bus it belongs to
+     struct BusSlot {
+       Bus *bus;
+       int index;
+     };
      /*Represents a single signal*/
-     class Signal {
+     class Signal : public ArenaObject {
      public:
        string name;
-       vector<Bus*> parentBuses; //Buses the signal belongs to
-       vector<LogicPort*> connectedPorts;
+       vector<BusSlot> parentBuses; //Buses the signal belongs to, and its position in each
+       //Ports are connected and disconnected using LogicPort::Connect and LogicPort::Disconnect
+       //Each port records its position in extraDrivers or fanout, so the order of these lists is not preserved
+       LogicPort *driver = nullptr; //Port driving the signal, nullptr if undriven
+       vector<LogicPort*> extraDrivers; //Any further ports driving the signal (which is an error)
+       vector<LogicPort*> fanout; //Ports the signal drives
        int GetFanout(); //Get number of inputs the signal connects to
-       void ConnectTo(Signal* other); //Move all connected ports to some other signal
+       int GetDriverCount(); //Get number of ports driving the signal
+       bool IsConnected(); //Returns true if any ports are connected to the signal
+       void AddPort(LogicPort *port);
+       void RemovePort(LogicPort *port);
+       //Merge the signal into some other signal, moving all connected ports to it. Ports aren't updated, but find
+       //the signal they are connected to through Resolve (see NetRef)
+       void ConnectTo(Signal* other);
+       //Return the signal this one has been merged into using ConnectTo, or the signal itself if it has not been merged
+       Signal *Resolve();
+       bool IsMerged() const { return mergedInto != nullptr; };
        bool GetConstantValue(bool &val); //Returns true and sets val if signal has constant 0/1 value (currently don't care is forced to zero)
        LogicDevice* GetDriver(); //Return the device driving the signal; or nullptr if the signal is not driven or driven by a top-level input
-       //Computed clock-to-valid delay for timing analysis purposes
-       double delay = 0;
+       //Computed clock-to-valid delay at each delay corner for timing analysis purposes
+       double delay[MaxTimingCorners] = {};
+       //Setup slack at the worst corner from the last post-pipeline timing analysis, infinite if the signal doesn't
+       //reach a register
+       double slack = numeric_limits<double>::infinity();
        //Pipeline latency for balancing purposes
        int latency = 0;
+       //Output of the register used to pipeline the signal, once one has been found or created during pipelining
+       Signal *pipelined = nullptr;
 
        bool avoidPipeline = false; //if true pipeline registers will not break this signal unless necessary (for local logic connections etc.)
 
        bool isSlow = false; //Signals that change rarely can be declared 'slow' and therefore aren't bothered with during pipelining as a speedhack
+     private:
+       //Cached properties of the drivers, updated whenever they change
+       LogicDevice *driverDevice = nullptr;
+       LogicState constantState = LogicState_Unknown;
+       //Signal this one was merged into, forming a union-find forest of merged signals
+       Signal *mergedInto = nullptr;
+       void UpdateDriverInfo();
+       void AddToList(vector<LogicPort*> &list, LogicPort *port);
+       void RemoveFromList(vector<LogicPort*> &list, LogicPort *port);
      };
      /*Represents a group of signals*/
-     class Bus {
+     class Bus : public ArenaObject {
      public:
         Bus();
         Bus(string _name, bool _is_signed, int _width);
         string name;
         vector<Signal*> signals;
+        //Append a signal to the bus, recording the bus in its parentBuses
+        void AddSignal(Signal *sig);
+        //Replace any signals that have been merged into another signal with the signal they were merged into
+        //This is needed for buses such as slices, whose signals are not updated by Signal::ConnectTo
+        void ResolveSignals();
         bool is_signed = false;
         int width = 1;
         bool GetConstantValue(long long &val); //Returns true and sets val if all signals are constant (don't cares are forced to zero)
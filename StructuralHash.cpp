@@ -0,0 +1,49 @@
+#include "StructuralHash.hpp"
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        LogicDevice *StructuralHash::FindEquivalent(LogicDevice *dev) {
+            size_t hash;
+            if(!dev->GetStructuralHash(hash))
+                return nullptr;
+            auto range = table.equal_range(hash);
+            for(auto it = range.first; it != range.second; ++it) {
+                if((it->second != dev) && dev->IsEquivalentTo(it->second)) {
+                    return it->second;
+                }
+            }
+            return nullptr;
+        }
+
+        void StructuralHash::Insert(LogicDevice *dev) {
+            if(dev->inStructuralHash)
+                return;
+            if(dev->GetStructuralHash(dev->structuralHash)) {
+                table.insert(make_pair(dev->structuralHash, dev));
+                dev->inStructuralHash = true;
+            }
+        }
+
+        void StructuralHash::Remove(LogicDevice *dev) {
+            if(!dev->inStructuralHash)
+                return;
+            //The key stored at insertion is used, as the device may have changed since
+            auto range = table.equal_range(dev->structuralHash);
+            for(auto it = range.first; it != range.second; ++it) {
+                if(it->second == dev) {
+                    table.erase(it);
+                    break;
+                }
+            }
+            dev->inStructuralHash = false;
+        }
+
+        void StructuralHash::Clear() {
+            for(auto entry : table) {
+                entry.second->inStructuralHash = false;
+            }
+            table.clear();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "LogicDevice.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    //Mix a value into a running hash
+    inline size_t HashCombine(size_t seed, size_t value) {
+      return seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    /*
+    Hash-consing table of devices, keyed on the kind of device, its configuration (such as LUT contents) and its
+    ordered input nets. This finds equivalent devices in O(1) rather than comparing every pair of devices sharing a net
+    Keys of devices in the table are only valid as long as their inputs are unchanged, so whenever a device is
+    changed it must be removed and reinserted. Candidates are always checked using IsEquivalentTo
+    */
+    class StructuralHash {
+    public:
+      //Return a device in the table that is equivalent to a given device, or nullptr if there is none
+      LogicDevice *FindEquivalent(LogicDevice *dev);
+      //Add a device to the table; devices that cannot be hashed are ignored
+      void Insert(LogicDevice *dev);
+      //Remove a device from the table if it is present
+      void Remove(LogicDevice *dev);
+      void Clear();
+    private:
+      unordered_multimap<size_t, LogicDevice*> table;
+    };
+  }
+}
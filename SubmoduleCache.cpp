@@ -0,0 +1,77 @@
+#include "SubmoduleCache.hpp"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        const ParsedNetlist *SubmoduleCache::Get(const string &name, const vector<string> &searchPath) {
+            auto found = modules.find(name);
+            if(found == modules.end()) {
+                found = modules.emplace(name, Load(name, searchPath)).first;
+            }
+            return found->second.get();
+        }
+
+        void SubmoduleCache::Prefetch(const vector<string> &names, const vector<string> &searchPath) {
+            vector<string> pending;
+            for(auto name : names) {
+                if((modules.find(name) == modules.end()) && (find(pending.begin(), pending.end(), name) == pending.end())) {
+                    pending.push_back(name);
+                }
+            }
+            //Each round parses every submodule found to be needed by the previous round
+            while(!pending.empty()) {
+                vector<unique_ptr<ParsedNetlist>> parsed(pending.size());
+                atomic<int> next(0);
+                auto worker = [&]() {
+                    int i;
+                    while((i = next++) < int(pending.size())) {
+                        parsed[i] = Load(pending[i], searchPath);
+                    }
+                };
+                int threadCount = min<int>(max<int>(thread::hardware_concurrency(), 1), pending.size());
+                vector<thread> threads;
+                for(int i = 1; i < threadCount; i++) {
+                    threads.push_back(thread(worker));
+                }
+                worker();
+                for(auto &t : threads) {
+                    t.join();
+                }
+
+                vector<string> included;
+                for(int i = 0; i < pending.size(); i++) {
+                    if(parsed[i] != nullptr) {
+                        for(auto inc : parsed[i]->includes) {
+                            if((modules.find(inc) == modules.end()) && (find(pending.begin(), pending.end(), inc) == pending.end())
+                                && (find(included.begin(), included.end(), inc) == included.end())) {
+                                included.push_back(inc);
+                            }
+                        }
+                    }
+                    modules.emplace(pending[i], move(parsed[i]));
+                }
+                pending = included;
+            }
+        }
+
+        void SubmoduleCache::Clear() {
+            modules.clear();
+        }
+
+        unique_ptr<ParsedNetlist> SubmoduleCache::Load(const string &name, const vector<string> &searchPath) {
+            static const vector<string> allowedExtensions{".polynet.enc", ".ecc.polynet.enc", ".polynet", ".ecc.polynet"};
+            unique_ptr<ParsedNetlist> module(new ParsedNetlist());
+            for(auto dir : searchPath) {
+                for(auto ext : allowedExtensions) {
+                    if(module->Load(dir + "/" + name + ext)) {
+                        return module;
+                    }
+                }
+            }
+            return nullptr;
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include "NetlistReader.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    /*
+    Submodules included by a design, each found and parsed once however many times it is instantiated
+    Submodules can be prefetched, in which case independent files are read and parsed concurrently. Only reading and
+    tokenizing happens on other threads; instantiating a submodule into a design is always done by the caller
+    */
+    class SubmoduleCache {
+    public:
+      //Return the parsed form of a submodule, parsing it if it has not already been, or nullptr if it can't be found
+      const ParsedNetlist *Get(const string &name, const vector<string> &searchPath);
+      //Parse a set of submodules and everything they include in turn, using a thread pool
+      void Prefetch(const vector<string> &names, const vector<string> &searchPath);
+      //Release all parsed submodules
+      void Clear();
+    private:
+      //Parsed submodules, or nullptr for submodules that couldn't be found
+      unordered_map<string, unique_ptr<ParsedNetlist>> modules;
+      //Search for a submodule's file and parse it, returning nullptr if it can't be found
+      static unique_ptr<ParsedNetlist> Load(const string &name, const vector<string> &searchPath);
+    };
+  }
+}
@@ -0,0 +1,171 @@
+#include "TimingModel.hpp"
+#include "NetlistReader.hpp"
+#include "Util.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <limits>
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        static const KeywordTable<DeviceKind> deviceNames({
+            {"CARRY4", DEVICE_XILINX_CARRY4},
+            {"DSP48MUL", DEVICE_XILINX_DSP48MUL},
+            {"CARRYSUM", DEVICE_ALTERA_CARRYSUM},
+            {"ROM", DEVICE_ALTERA_ROM},
+            {"MULTIPLIER18", DEVICE_ALTERA_MULTIPLIER18},
+            {"SRL", DEVICE_XILINX_SRL},
+            {"SHIFTTAPS", DEVICE_ALTERA_SHIFTTAPS}
+        });
+
+        static double ParseDelay(const Token &token, int lno) {
+            string str = token.str();
+            char *end;
+            double value = strtod(str.c_str(), &end);
+            if((*end != '\0') || (value < 0)) {
+                PrintMessage(MSG_ERROR, "invalid delay " + str + " in timing model", lno);
+            }
+            return value * 1e-9;
+        }
+
+        static int ParseIndex(const string &str, int lno) {
+            char *end;
+            long value = strtol(str.c_str(), &end, 10);
+            if((str == "") || (*end != '\0') || (value < 0) || (value > INT_MAX)) {
+                PrintMessage(MSG_ERROR, "invalid port index " + str + " in timing model", lno);
+            }
+            return value;
+        }
+
+        bool TimingModel::Load(string filename) {
+            MappedFile file;
+            if(!file.Open(filename)) {
+                return false;
+            }
+            NetlistTokenizer tokenizer(file.GetData(), file.GetData() + file.GetSize());
+            vector<Token> line;
+            auto ParseRange = [](const Token &token, int lno) {
+                PortRange range;
+                string str = token.str();
+                size_t colon = str.find(':');
+                if(str == "*") {
+                    range.first = 0;
+                    range.last = INT_MAX;
+                } else if(colon != string::npos) {
+                    range.first = ParseIndex(str.substr(0, colon), lno);
+                    range.last = ParseIndex(str.substr(colon + 1), lno);
+                } else {
+                    range.first = range.last = ParseIndex(str, lno);
+                }
+                return range;
+            };
+            auto ParseDevice = [](const Token &token, int lno) {
+                DeviceKind kind = DEVICE_OTHER;
+                if(!deviceNames.Find(token, kind)) {
+                    PrintMessage(MSG_ERROR, "unknown device " + token.str() + " in timing model", lno);
+                }
+                return kind;
+            };
+            for(int lno = 1; tokenizer.NextLine(line); lno++) {
+                if(line.size() == 0)
+                    continue;
+                if((line[0] == "LUT_DELAY") && (line.size() >= 2)) {
+                    lutPinDelay.clear();
+                    for(int i = 1; i < int(line.size()); i++) {
+                        lutPinDelay.push_back(ParseDelay(line[i], lno));
+                    }
+                } else if((line[0] == "FF_CLOCK_TO_OUT") && (line.size() == 2)) {
+                    clockToOut = ParseDelay(line[1], lno);
+                } else if((line[0] == "FF_SETUP") && (line.size() == 2)) {
+                    setupTime = ParseDelay(line[1], lno);
+                } else if((line[0] == "ROUTING") && (line.size() == 3)) {
+                    routing.push_back(make_pair(ParseIndex(line[1].str(), lno), ParseDelay(line[2], lno)));
+                } else if((line[0] == "ARC") && (line.size() == 5)) {
+                    Arc arc;
+                    arc.kind = ParseDevice(line[1], lno);
+                    arc.inputs = ParseRange(line[2], lno);
+                    arc.outputs = ParseRange(line[3], lno);
+                    arc.delay = ParseDelay(line[4], lno);
+                    arcs.push_back(arc);
+                } else if((line[0] == "OUTPUT") && (line.size() == 4)) {
+                    Arc output;
+                    output.kind = ParseDevice(line[1], lno);
+                    output.inputs.first = output.inputs.last = -1;
+                    output.outputs = ParseRange(line[2], lno);
+                    output.delay = ParseDelay(line[3], lno);
+                    outputDelays.push_back(output);
+                } else {
+                    PrintMessage(MSG_ERROR, "invalid timing model statement " + line[0].str(), lno);
+                }
+            }
+            sort(routing.begin(), routing.end());
+            return true;
+        }
+
+        bool TimingModel::GetLUTPinDelay(int pin, double &delay) const {
+            if(lutPinDelay.empty())
+                return false;
+            delay = lutPinDelay[min<int>(pin, lutPinDelay.size() - 1)];
+            return true;
+        }
+
+        bool TimingModel::GetClockToOut(double &delay) const {
+            if(clockToOut < 0)
+                return false;
+            delay = clockToOut;
+            return true;
+        }
+
+        bool TimingModel::GetSetupTime(double &delay) const {
+            if(setupTime < 0)
+                return false;
+            delay = setupTime;
+            return true;
+        }
+
+        bool TimingModel::GetRoutingDelay(int fanout, double &delay) const {
+            if(routing.empty())
+                return false;
+            if(routing.size() == 1) {
+                delay = routing[0].second;
+                return true;
+            }
+            //Interpolate between the two entries either side of the fanout, or the nearest two at either end
+            auto upper = upper_bound(routing.begin(), routing.end(), make_pair(fanout, numeric_limits<double>::infinity()));
+            if(upper == routing.begin()) {
+                upper++;
+            } else if(upper == routing.end()) {
+                upper--;
+            }
+            auto lower = upper - 1;
+            if(upper->first == lower->first) {
+                delay = upper->second;
+            } else {
+                double t = double(fanout - lower->first) / double(upper->first - lower->first);
+                delay = max(0.0, lower->second + t * (upper->second - lower->second));
+            }
+            return true;
+        }
+
+        bool TimingModel::GetArcDelay(DeviceKind kind, int input, int output, double &delay) const {
+            for(auto it = arcs.rbegin(); it != arcs.rend(); ++it) {
+                if((it->kind == kind) && it->inputs.Contains(input) && it->outputs.Contains(output)) {
+                    delay = it->delay;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool TimingModel::GetOutputDelay(DeviceKind kind, int output, double &delay) const {
+            for(auto it = outputDelays.rbegin(); it != outputDelays.rend(); ++it) {
+                if((it->kind == kind) && it->outputs.Contains(output)) {
+                    delay = it->delay;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+}
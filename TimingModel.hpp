@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "LogicDevice.hpp"
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+    /*
+    Delays of a device family loaded from a file, so that timing can be calibrated against vendor timing reports.
+    Any delay the file doesn't give is taken from the built in model of the technology
+
+    Each line is a keyword followed by its values, with times in nanoseconds. Anything after a '#' is ignored
+      LUT_DELAY d0 d1 ...          delay from each LUT input to the output, input 0 first. The last value is also used
+                                   for any further inputs
+      FF_CLOCK_TO_OUT d            flip flop clock to output delay
+      FF_SETUP d                   flip flop setup time
+      ROUTING fanout d             routing delay of nets driven by LUTs, for nets with a given fanout. Delays for
+                                   fanouts between entries are interpolated, and beyond the last entry extrapolated
+      ARC device inputs outputs d  delay through a vendor specific device from inputs to outputs, such as one bit of a
+                                   carry chain. Ports are given by index, as a single index, a range such as 2:5, or *
+                                   for all ports. Later lines take precedence over earlier ones. This only changes
+                                   the delay of paths the device has, and can't add new ones
+      OUTPUT device outputs d      delay of registered outputs of a vendor specific device, which have no arcs
+    Devices are CARRY4, DSP48MUL, SRL, CARRYSUM, ROM, MULTIPLIER18 and SHIFTTAPS
+    */
+    class TimingModel {
+    public:
+      //Load a timing model from a file, returning false if the file could not be opened. Invalid lines are errors
+      bool Load(string filename);
+
+      //Each of these returns false if the model doesn't give the delay, leaving delay unchanged
+      bool GetLUTPinDelay(int pin, double &delay) const;
+      bool GetClockToOut(double &delay) const;
+      bool GetSetupTime(double &delay) const;
+      bool GetRoutingDelay(int fanout, double &delay) const;
+      bool GetArcDelay(DeviceKind kind, int input, int output, double &delay) const;
+      bool GetOutputDelay(DeviceKind kind, int output, double &delay) const;
+    private:
+      struct PortRange {
+        int first, last;
+        bool Contains(int port) const { return (port >= first) && (port <= last); };
+      };
+      struct Arc {
+        DeviceKind kind;
+        PortRange inputs, outputs;
+        double delay;
+      };
+
+      vector<double> lutPinDelay;
+      double clockToOut = -1, setupTime = -1; //negative if not given
+      vector<pair<int, double>> routing; //sorted by fanout
+      vector<Arc> arcs;
+      vector<Arc> outputDelays; //inputs unused
+    };
+  }
+}
@@ -0,0 +1,284 @@
+#include "TruthTable.hpp"
+#include "Util.hpp"
+using namespace std;
+
+namespace SynthFramework {
+    namespace Polymer {
+        //Masks of the entries within a word where a given input is high
+        static const uint64_t inputMasks[6] = {
+            0xAAAAAAAAAAAAAAAAULL,
+            0xCCCCCCCCCCCCCCCCULL,
+            0xF0F0F0F0F0F0F0F0ULL,
+            0xFF00FF00FF00FF00ULL,
+            0xFFFF0000FFFF0000ULL,
+            0xFFFFFFFF00000000ULL
+        };
+
+        //Mask of the valid entries in the word of a table with up to 6 inputs
+        static uint64_t ValidMask(int inputCount) {
+            if(inputCount >= 6) {
+                return ~0ULL;
+            } else {
+                return (1ULL << (1 << inputCount)) - 1;
+            }
+        }
+
+        //Exchange inputs a and b (a < b < 6) within a single word
+        static uint64_t SwapInWord(uint64_t w, int a, int b) {
+            int shift = (1 << b) - (1 << a);
+            uint64_t up = inputMasks[a] & ~inputMasks[b];
+            uint64_t down = ~inputMasks[a] & inputMasks[b];
+            return (w & ~(up | down)) | ((w & up) << shift) | ((w & down) >> shift);
+        }
+
+        //Take the cofactor of a word with respect to an input (< 6) and shuffle that input out to the top of the word,
+        //so the lower half of the result holds the cofactor with the remaining inputs in their original order
+        static uint64_t CofactorInWord(uint64_t w, int input, bool value, int inputCount) {
+            int shift = 1 << input;
+            uint64_t c;
+            if(value) {
+                c = (w >> shift) & ~inputMasks[input];
+            } else {
+                c = w & ~inputMasks[input];
+            }
+            //replicate so the word no longer depends on the eliminated input, which can then be moved freely
+            c |= (c << shift);
+            for(int i = input; i < (inputCount - 1); i++) {
+                c = SwapInWord(c, i, i + 1);
+            }
+            return c;
+        }
+
+        TruthTable::TruthTable() {
+
+        }
+
+        TruthTable::TruthTable(int _inputCount) {
+            inputCount = _inputCount;
+            if(inputCount > 6) {
+                wideWords.assign(1ULL << (inputCount - 6), 0);
+            }
+        }
+
+        TruthTable::TruthTable(const vector<bool> &entries) {
+            int n = 0;
+            while((1 << n) < entries.size()) {
+                n++;
+            }
+            if((1 << n) != entries.size()) {
+                PrintMessage(MSG_ERROR, "truth table size must be a power of two");
+            }
+            *this = TruthTable(n);
+            for(int i = 0; i < entries.size(); i++) {
+                Set(i, entries[i]);
+            }
+        }
+
+        int TruthTable::GetInputCount() const {
+            return inputCount;
+        }
+
+        int TruthTable::GetSize() const {
+            return 1 << inputCount;
+        }
+
+        int TruthTable::GetWordCount() const {
+            if(inputCount <= 6) {
+                return 1;
+            } else {
+                return 1 << (inputCount - 6);
+            }
+        }
+
+        uint64_t *TruthTable::GetWords() {
+            if(inputCount <= 6) {
+                return &word;
+            } else {
+                return wideWords.data();
+            }
+        }
+
+        const uint64_t *TruthTable::GetWords() const {
+            if(inputCount <= 6) {
+                return &word;
+            } else {
+                return wideWords.data();
+            }
+        }
+
+        bool TruthTable::Get(int index) const {
+            return ((GetWords()[index >> 6] >> (index & 63)) & 0x1) != 0;
+        }
+
+        void TruthTable::Set(int index, bool value) {
+            uint64_t bit = 1ULL << (index & 63);
+            if(value) {
+                GetWords()[index >> 6] |= bit;
+            } else {
+                GetWords()[index >> 6] &= ~bit;
+            }
+        }
+
+        bool TruthTable::IsInputRedundant(int input) const {
+            const uint64_t *words = GetWords();
+            int wordCount = GetWordCount();
+            if(input < 6) {
+                //compare every entry with input low against the entry with input high
+                int shift = 1 << input;
+                uint64_t mask = ~inputMasks[input] & ValidMask(inputCount);
+                for(int i = 0; i < wordCount; i++) {
+                    if((((words[i] >> shift) ^ words[i]) & mask) != 0) {
+                        return false;
+                    }
+                }
+            } else {
+                int wordBit = 1 << (input - 6);
+                for(int i = 0; i < wordCount; i++) {
+                    if(((i & wordBit) == 0) && (words[i] != words[i | wordBit])) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        TruthTable TruthTable::EliminateInput(int input, bool value) const {
+            TruthTable result(inputCount - 1);
+            const uint64_t *words = GetWords();
+            uint64_t *newWords = result.GetWords();
+            if(inputCount <= 6) {
+                newWords[0] = CofactorInWord(words[0], input, value, inputCount) & ValidMask(inputCount - 1);
+            } else if(input >= 6) {
+                //whole words are picked according to the value of the input
+                int wordBit = 1 << (input - 6);
+                int n = 0;
+                for(int i = 0; i < GetWordCount(); i++) {
+                    if(((i & wordBit) != 0) == value) {
+                        newWords[n++] = words[i];
+                    }
+                }
+            } else {
+                //each word shrinks to 32 entries, and pairs of these are packed back together
+                for(int i = 0; i < result.GetWordCount(); i++) {
+                    uint64_t lo = CofactorInWord(words[2*i], input, value, 6) & 0xFFFFFFFFULL;
+                    uint64_t hi = CofactorInWord(words[2*i+1], input, value, 6) & 0xFFFFFFFFULL;
+                    newWords[i] = lo | (hi << 32);
+                }
+            }
+            return result;
+        }
+
+        TruthTable TruthTable::Select(const TruthTable &whenLow, const TruthTable &whenHigh, int var) {
+            TruthTable result(whenLow.inputCount);
+            const uint64_t *lo = whenLow.GetWords(), *hi = whenHigh.GetWords();
+            uint64_t *out = result.GetWords();
+            for(int i = 0; i < result.GetWordCount(); i++) {
+                if(var < 6) {
+                    out[i] = (lo[i] & ~inputMasks[var]) | (hi[i] & inputMasks[var]);
+                } else if((i & (1 << (var - 6))) != 0) {
+                    out[i] = hi[i];
+                } else {
+                    out[i] = lo[i];
+                }
+            }
+            out[0] &= ValidMask(result.inputCount);
+            return result;
+        }
+
+        TruthTable TruthTable::MergeInputs(int keep, int remove) const {
+            //Only entries where the two inputs have the same value are of interest
+            TruthTable whenLow = EliminateInput(remove, false);
+            TruthTable whenHigh = EliminateInput(remove, true);
+            if(keep > remove) {
+                keep--;
+            }
+            return Select(whenLow, whenHigh, keep);
+        }
+
+        void TruthTable::SwapInputs(int a, int b) {
+            if(a == b) return;
+            if(a > b) swap(a, b);
+            uint64_t *words = GetWords();
+            int wordCount = GetWordCount();
+            if(b < 6) {
+                for(int i = 0; i < wordCount; i++) {
+                    words[i] = SwapInWord(words[i], a, b);
+                }
+            } else if(a < 6) {
+                //entries move between the pairs of words selected by input b
+                int wordBit = 1 << (b - 6);
+                int shift = 1 << a;
+                for(int i = 0; i < wordCount; i++) {
+                    if((i & wordBit) == 0) {
+                        uint64_t w0 = words[i], w1 = words[i | wordBit];
+                        words[i] = (w0 & ~inputMasks[a]) | ((w1 & ~inputMasks[a]) << shift);
+                        words[i | wordBit] = ((w0 & inputMasks[a]) >> shift) | (w1 & inputMasks[a]);
+                    }
+                }
+            } else {
+                int bitA = 1 << (a - 6), bitB = 1 << (b - 6);
+                for(int i = 0; i < wordCount; i++) {
+                    if(((i & bitA) != 0) && ((i & bitB) == 0)) {
+                        swap(words[i], words[(i & ~bitA) | bitB]);
+                    }
+                }
+            }
+        }
+
+        TruthTable TruthTable::Compose(const TruthTable &inner, int pin) const {
+            TruthTable whenLow = EliminateInput(pin, false);
+            TruthTable whenHigh = EliminateInput(pin, true);
+            int m = inner.inputCount;
+            TruthTable result(inputCount - 1 + m);
+            uint64_t *out = result.GetWords();
+            const uint64_t *in = inner.GetWords();
+            int segmentWords = inner.GetWordCount();
+            uint64_t segmentMask = ValidMask(m);
+            //Each entry of the outer table becomes a block of 2^m entries: all low, all high, the inner table or its inverse
+            for(int u = 0; u < whenLow.GetSize(); u++) {
+                bool lo = whenLow.Get(u), hi = whenHigh.Get(u);
+                for(int i = 0; i < segmentWords; i++) {
+                    uint64_t segment;
+                    if(hi && lo) {
+                        segment = segmentMask;
+                    } else if(hi) {
+                        segment = in[i];
+                    } else if(lo) {
+                        segment = ~in[i] & segmentMask;
+                    } else {
+                        segment = 0;
+                    }
+                    if(m >= 6) {
+                        out[u * segmentWords + i] = segment;
+                    } else {
+                        int offset = u << m;
+                        out[offset >> 6] |= segment << (offset & 63);
+                    }
+                }
+            }
+            return result;
+        }
+
+        bool TruthTable::operator==(const TruthTable &other) const {
+            if(inputCount != other.inputCount) return false;
+            const uint64_t *a = GetWords(), *b = other.GetWords();
+            for(int i = 0; i < GetWordCount(); i++) {
+                if(a[i] != b[i]) return false;
+            }
+            return true;
+        }
+
+        bool TruthTable::operator!=(const TruthTable &other) const {
+            return !(*this == other);
+        }
+
+        size_t TruthTable::Hash() const {
+            uint64_t h = inputCount;
+            const uint64_t *words = GetWords();
+            for(int i = 0; i < GetWordCount(); i++) {
+                h ^= words[i] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+            }
+            return h;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+using namespace std;
+
+namespace SynthFramework {
+  namespace Polymer {
+     /*
+     A bit-packed truth table, entry i being the output value when the inputs take the binary value i
+     (input 0 is the least significant bit). Tables of up to 6 inputs live in a single 64-bit word,
+     wider tables use one word per 64 entries
+     */
+     class TruthTable {
+     public:
+       //Initialise a zero-input table (constant 0)
+       TruthTable();
+       //Initialise a table with the given number of inputs, all entries 0
+       explicit TruthTable(int _inputCount);
+       //Initialise a table from a list of entries, the size of which must be a power of two
+       TruthTable(const vector<bool> &entries);
+
+       int GetInputCount() const;
+       //Number of entries in the table
+       int GetSize() const;
+       bool Get(int index) const;
+       void Set(int index, bool value);
+       bool operator[](int index) const { return Get(index); };
+
+       //Return true if a given input has no bearing on the output value
+       bool IsInputRedundant(int input) const;
+       //Return a new table with one input eliminated and forced to a constant value
+       TruthTable EliminateInput(int input, bool value) const;
+       //Return a new table for when two inputs are known to be equal, with input 'remove' eliminated
+       TruthTable MergeInputs(int keep, int remove) const;
+       //Exchange the roles of two inputs
+       void SwapInputs(int a, int b);
+       //Return the table obtained by feeding input 'pin' from another table
+       //The inputs of the other table are placed at the start, followed by the remaining inputs of this table
+       TruthTable Compose(const TruthTable &inner, int pin) const;
+
+       bool operator==(const TruthTable &other) const;
+       bool operator!=(const TruthTable &other) const;
+       size_t Hash() const;
+     private:
+       int inputCount = 0;
+       uint64_t word = 0; //all entries when inputCount <= 6, unused bits are kept at zero
+       vector<uint64_t> wideWords; //entries when inputCount > 6
+
+       int GetWordCount() const;
+       uint64_t *GetWords();
+       const uint64_t *GetWords() const;
+       //Return the table with input 'var' used to pick between two tables of the same size
+       static TruthTable Select(const TruthTable &whenLow, const TruthTable &whenHigh, int var);
+     };
+  }
+}
@@ -23,25 +23,27 @@ namespace SynthFramework {
         }
 
         string Artix7Technology::GenerateDevice(LogicDevice* dev) {
-            LUT* lut = dynamic_cast<LUT*>(dev);
-            FlipFlop *ff= dynamic_cast<FlipFlop*>(dev);
-            Xilinx_Carry4 *ca4 = dynamic_cast<Xilinx_Carry4*>(dev);
-            if(lut != nullptr) {
-                return SynthesiseLUT(lut);
-            } else if(ff != nullptr) {
-                return SynthesiseFF(ff);
-            } else if(ca4 != nullptr) {
-                return SynthesiseCarry4(ca4);
-            } else {
+            switch(dev->kind) {
+            case DEVICE_LUT:
+                return SynthesiseLUT(static_cast<LUT*>(dev));
+            case DEVICE_FLIPFLOP:
+                return SynthesiseFF(static_cast<FlipFlop*>(dev));
+            case DEVICE_XILINX_CARRY4:
+                return SynthesiseCarry4(static_cast<Xilinx_Carry4*>(dev));
+            case DEVICE_XILINX_SRL:
+                return SynthesiseSRL(static_cast<Xilinx_SRL*>(dev));
+            default:
                 return "";
             }
-
         }
 
         string Artix7Technology::GenerateDeviceSignals(LogicDevice* dev) {
-            Xilinx_Carry4 *ca4 = dynamic_cast<Xilinx_Carry4*>(dev);
+            Xilinx_Carry4 *ca4 = DeviceCast<Xilinx_Carry4>(dev);
+            Xilinx_SRL *srl = DeviceCast<Xilinx_SRL>(dev);
             if(ca4 != nullptr) {
                 return SynthesiseCarry4Signals(ca4);
+            } else if(srl != nullptr) {
+                return SynthesiseSRLSignals(srl);
             } else {
                 return "";
             }
@@ -77,6 +79,17 @@ namespace SynthFramework {
 
         }
 
+        bool Artix7Technology::IsShiftRegisterSuitable(int width, int depth) {
+            //Each bit uses its own LUT, which only saves anything over flip flops for longer chains
+            return depth >= 3;
+        }
+
+        void Artix7Technology::SynthesiseShiftRegister(const vector<Signal*> &D, const vector<Signal*> &Q, int depth, Signal *clock, Signal *enable, LogicDesign *topLevel) {
+            for(int i = 0; i < D.size(); i++) {
+                topLevel->AddDevice(new Xilinx_SRL(depth, D[i], clock, enable, Q[i]));
+            }
+        }
+
         string Artix7Technology::SynthesiseLUT(LUT *lut) {
             //More advanced synthesis would generate 2-output LUTs, and also pack LUTs into CLBS thus using the LO pins
             //and enabling more accurate timing analysis
@@ -89,7 +102,7 @@ namespace SynthFramework {
             stringstream vhdl;
             vhdl << "\t" << lut->name << " : " << entType << " generic map(" << endl;
             vhdl << "\t\t\tINIT => \"";
-            for(int i = lut->lutContent.size() - 1; i >= 0; i--) {
+            for(int i = lut->lutContent.GetSize() - 1; i >= 0; i--) {
                 if(lut->lutContent[i]) {
                     vhdl << "1";
                 } else {
@@ -168,6 +181,63 @@ namespace SynthFramework {
         }
 
 
+        string Artix7Technology::SynthesiseSRL(Xilinx_SRL *srl) {
+            stringstream vhdl;
+            string ce = srl->hasEnable ? srl->inputPorts[2]->connectedNet->name : "'1'";
+            if(srl->depth <= 16) {
+                vhdl << "\t" << srl->name << " : SRL16E generic map(" << endl;
+                vhdl << "\t\t\tINIT => X\"0000\") port map(" << endl;
+                vhdl << "\t\t\tQ => " << srl->outputPorts[0]->connectedNet->name << ", " << endl;
+                for(int i = 0; i < 4; i++) {
+                    vhdl << "\t\t\tA" << i << " => '" << (((srl->depth - 1) >> i) & 1) << "', " << endl;
+                }
+                vhdl << "\t\t\tCE => " << ce << ", " << endl;
+                vhdl << "\t\t\tCLK => " << srl->inputPorts[1]->connectedNet->name << ", " << endl;
+                vhdl << "\t\t\tD => " << srl->inputPorts[0]->connectedNet->name << ");" << endl << endl;
+            } else {
+                //Longer delays use a cascade of 32-bit shift registers, with the last one tapped to give the delay
+                int stages = (srl->depth + 31) / 32;
+                for(int i = 0; i < stages; i++) {
+                    int address = (i == (stages - 1)) ? (srl->depth - 32 * i - 1) : 31;
+                    vhdl << "\t" << srl->name;
+                    if(stages > 1) {
+                        vhdl << "_" << i;
+                    }
+                    vhdl << " : SRLC32E generic map(" << endl;
+                    vhdl << "\t\t\tINIT => X\"00000000\") port map(" << endl;
+                    if(i == (stages - 1)) {
+                        vhdl << "\t\t\tQ => " << srl->outputPorts[0]->connectedNet->name << ", " << endl;
+                        vhdl << "\t\t\tQ31 => open, " << endl;
+                    } else {
+                        vhdl << "\t\t\tQ => open, " << endl;
+                        vhdl << "\t\t\tQ31 => " << srl->name << "_cascade(" << i << "), " << endl;
+                    }
+                    vhdl << "\t\t\tA => \"";
+                    for(int j = 4; j >= 0; j--) {
+                        vhdl << ((address >> j) & 1);
+                    }
+                    vhdl << "\", " << endl;
+                    vhdl << "\t\t\tCE => " << ce << ", " << endl;
+                    vhdl << "\t\t\tCLK => " << srl->inputPorts[1]->connectedNet->name << ", " << endl;
+                    if(i == 0) {
+                        vhdl << "\t\t\tD => " << srl->inputPorts[0]->connectedNet->name << ");" << endl << endl;
+                    } else {
+                        vhdl << "\t\t\tD => " << srl->name << "_cascade(" << (i - 1) << "));" << endl << endl;
+                    }
+                }
+            }
+            return vhdl.str();
+        }
+
+        string Artix7Technology::SynthesiseSRLSignals(Xilinx_SRL *srl) {
+            stringstream vhdl;
+            int stages = (srl->depth + 31) / 32;
+            if(stages > 1) {
+                vhdl << "\tsignal " << srl->name << "_cascade : std_logic_vector(" << (stages - 2) << " downto 0);" << endl;
+            }
+            return vhdl.str();
+        }
+
         void Artix7Technology::GenerateAdderChain(Operation *oper, bool isSub, LogicDesign *topLevel) {
             int adderSize = (oper->output->width + 3) / 4; //round up to nearest multiple of 4
             Signal *carryChain = nullptr;
@@ -181,7 +251,7 @@ namespace SynthFramework {
                         Signal *inPin = oper->GetInputSignal(k, bit, topLevel);
                         if((k == 1) && isSub) { //need to invert B input for a subtractor
                             Signal *invPin = topLevel->CreateSignal(oper->name + "_invB_" + to_string(bit));
-                            topLevel->devices.push_back(new LUT(Device_NOT, vector<Signal*>{inPin}, invPin));
+                            topLevel->AddDevice(new LUT(Device_NOT, vector<Signal*>{inPin}, invPin));
                             inPins.push_back(invPin);
                         } else {
                             inPins.push_back(inPin);
@@ -189,8 +259,8 @@ namespace SynthFramework {
                     }
                     DI.push_back(topLevel->CreateSignal(oper->name + "_DI" + to_string(bit)));
                     S.push_back(topLevel->CreateSignal(oper->name + "_S" + to_string(bit)));
-                    topLevel->devices.push_back(new LUT(Device_AND2, inPins, DI[j]));
-                    topLevel->devices.push_back(new LUT(Device_XOR2, inPins, S[j]));
+                    topLevel->AddDevice(new LUT(Device_AND2, inPins, DI[j]));
+                    topLevel->AddDevice(new LUT(Device_XOR2, inPins, S[j]));
                     O.push_back(topLevel->CreateSignal(oper->name + "_O" + to_string(bit)));
                     CO.push_back(topLevel->CreateSignal(oper->name + "_CO" + to_string(bit)));
                     if(bit < oper->output->width) {
@@ -209,51 +279,75 @@ namespace SynthFramework {
                     ci = carryChain;
                 }
 
-                topLevel->devices.push_back(new Xilinx_Carry4(ci, cinit, DI, S, O, CO));
+                topLevel->AddDevice(new Xilinx_Carry4(ci, cinit, DI, S, O, CO));
 
                 carryChain = CO[3];
             }
         }
 
-        void Artix7Technology::AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel) {
-            Xilinx_Carry4 *ca4 = dynamic_cast<Xilinx_Carry4*>(dev);
-            Xilinx_DSP48Mul *dsp48 = dynamic_cast<Xilinx_DSP48Mul*>(dev);
-
-            double worst_input_tpd = 0;
-            for(auto input : dev->inputPorts) {
-                LogicDevice* outputDriver = input->connectedNet->GetDriver();
-                if(outputDriver != nullptr) {
-                    if(dynamic_cast<LUT*>(outputDriver) != nullptr) {
-                        worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay + GetRoutingDelay_LUT_LUT());
-                    } else {
-                        worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay);
-                    }
-                } else {
-                    worst_input_tpd = max(worst_input_tpd, input->connectedNet->delay);
-                }
-            }
+       bool Artix7Technology::GetBuiltinTimingArc(VendorSpecificDevice *dev, int input, int output, bool lutDriven, double &routingDelay, double &cellDelay) {
+           routingDelay = lutDriven ? GetRoutingDelay_LUT_LUT() : 0;
+           if(dev->kind == DEVICE_XILINX_CARRY4) {
+               //Rough timing figure, not in datasheet for some reason
+               cellDelay = 0.3e-9;
+               return true;
+           } else if((dev->kind == DEVICE_XILINX_DSP48MUL) && (static_cast<Xilinx_DSP48Mul*>(dev)->latency == 0)) {
+               cellDelay = 4.3e-9;
+               return true;
+           }
+           //Outputs of pipelined DSPs and shift registers come from registers
+           return false;
+       }
 
-            if(ca4 != nullptr) {
-                for(auto output : ca4->outputPorts) {
-                    //Rough timing figure, not in datasheet for some reason
-                    output->connectedNet->delay = worst_input_tpd + 0.3e-9;
-                }
-            } else if(dsp48 != nullptr) {
-                for(auto output : dsp48->outputPorts) {
-                    if(dsp48->latency == 0) {
-                        output->connectedNet->delay = worst_input_tpd + 4.3e-9;
-                    } else if(dsp48->latency == 1) {
-                        output->connectedNet->delay = 1.9e-9;
-                    } else if(dsp48->latency == 2) {
-                        output->connectedNet->delay = 1.9e-9;
-                    }
-                }
-            }
+       double Artix7Technology::GetBuiltinOutputDelay(VendorSpecificDevice *dev, int output) {
+           if(dev->kind == DEVICE_XILINX_DSP48MUL) {
+               return 1.9e-9;
+           } else if(dev->kind == DEVICE_XILINX_SRL) {
+               //Clock to output of a LUT used as a shift register is much slower than that of a flip flop
+               return 1.2e-9;
+           }
+           return 0;
        }
 
        string Artix7Technology::PrintResourceUsage(LogicDesign *topLevel) {
-           //TODO
-           return "";
+           int logicLUTcount = 0;
+           int srlLUTcount = 0;
+           int regCount = 0;
+           int carryCount = 0;
+           int dspCount = 0;
+           for(auto dev : topLevel->devices) {
+               switch(dev->kind) {
+               case DEVICE_LUT:
+                   logicLUTcount++;
+                   break;
+               case DEVICE_FLIPFLOP:
+                   regCount++;
+                   break;
+               case DEVICE_XILINX_CARRY4:
+                   carryCount++;
+                   break;
+               case DEVICE_XILINX_DSP48MUL:
+                   dspCount++;
+                   break;
+               case DEVICE_XILINX_SRL:
+                   //Each LUT holds up to 32 bits of shift register
+                   srlLUTcount += (static_cast<Xilinx_SRL*>(dev)->depth + 31) / 32;
+                   break;
+               default:
+                   break;
+               }
+           }
+
+           stringstream message;
+           message << "Artix-7 resource utilisation\n";
+           message << "  " <<  (logicLUTcount + srlLUTcount) << " LUTs\n";
+           message << "     " <<  logicLUTcount << " logic\n";
+           message << "     " <<  srlLUTcount << " shift registers\n";
+           message << "  " <<  regCount << " registers\n";
+           message << "  " <<  carryCount << " CARRY4s\n";
+           message << "  " <<  dspCount << " DSP48s";
+
+           return message.str();
        }
        void Artix7Technology::SetDeviceConstraint(const vector<string>& line) {
          //TODO
@@ -23,7 +23,11 @@ namespace SynthFramework {
 
             bool DeviceSpecificSynthesis(Operation *oper, LogicDesign* topLevel);
 
-            void AnalyseTiming(VendorSpecificDevice *dev, LogicDesign *topLevel);
+            bool IsShiftRegisterSuitable(int width, int depth);
+            void SynthesiseShiftRegister(const vector<Signal*> &D, const vector<Signal*> &Q, int depth, Signal *clock, Signal *enable, LogicDesign *topLevel);
+
+            bool GetBuiltinTimingArc(VendorSpecificDevice *dev, int input, int output, bool lutDriven, double &routingDelay, double &cellDelay);
+            double GetBuiltinOutputDelay(VendorSpecificDevice *dev, int output);
 
             string PrintResourceUsage(LogicDesign *topLevel);
 
@@ -33,6 +37,8 @@ namespace SynthFramework {
             string SynthesiseFF(FlipFlop *ff);
             string SynthesiseCarry4(Xilinx_Carry4 *ca4);
             string SynthesiseCarry4Signals(Xilinx_Carry4 *ca4);
+            string SynthesiseSRL(Xilinx_SRL *srl);
+            string SynthesiseSRLSignals(Xilinx_SRL *srl);
 
             //Generate adder chain using Carry4s
             void GenerateAdderChain(Operation *oper, bool isSub, LogicDesign *topLevel);
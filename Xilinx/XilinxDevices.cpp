@@ -1,37 +1,35 @@
 #include "XilinxDevices.hpp"
 #include "../LogicDesign.hpp"
+#include "../BinaryNetlist.hpp"
 using namespace std;
 namespace SynthFramework {
   namespace Polymer {
-      Xilinx_Carry4::Xilinx_Carry4() {
-          name = "carry4_" + to_string(carry4count);
-          carry4count++;
+      Xilinx_Carry4::Xilinx_Carry4() : VendorSpecificDevice(DEVICE_XILINX_CARRY4) {
+          name = "carry4_" + to_string(createdCount[DEVICE_XILINX_CARRY4]);
+          createdCount[DEVICE_XILINX_CARRY4]++;
       }
 
-      Xilinx_Carry4::Xilinx_Carry4(Signal *ci, Signal *cinit, vector<Signal*> DI, vector<Signal*> S, vector<Signal*> O, vector<Signal*> CO) {
-          name = "carry4_" + to_string(carry4count);
-          carry4count++;
+      Xilinx_Carry4::Xilinx_Carry4(Signal *ci, Signal *cinit, vector<Signal*> DI, vector<Signal*> S, vector<Signal*> O, vector<Signal*> CO) : VendorSpecificDevice(DEVICE_XILINX_CARRY4) {
+          name = "carry4_" + to_string(createdCount[DEVICE_XILINX_CARRY4]);
+          createdCount[DEVICE_XILINX_CARRY4]++;
 
           DeviceInputPort *cip = new DeviceInputPort();
           cip->device = this;
           cip->pin = 0;
-          cip->connectedNet = ci;
-          ci->connectedPorts.push_back(cip);
+          cip->Connect(ci);
           inputPorts.push_back(cip);
 
           DeviceInputPort *cinitp = new DeviceInputPort();
           cinitp->device = this;
           cinitp->pin = 1;
-          cinitp->connectedNet = cinit;
-          cinit->connectedPorts.push_back(cinitp);
+          cinitp->Connect(cinit);
           inputPorts.push_back(cinitp);
 
           for(int i = 0 ; i < 4; i++) {
               DeviceInputPort *dip = new DeviceInputPort();
               dip->device = this;
               dip->pin = 2 + i;
-              dip->connectedNet = DI[i];
-              DI[i]->connectedPorts.push_back(dip);
+              dip->Connect(DI[i]);
               inputPorts.push_back(dip);
           }
 
@@ -39,8 +37,7 @@ namespace SynthFramework {
               DeviceInputPort *sip = new DeviceInputPort();
               sip->device = this;
               sip->pin = 6 + i;
-              sip->connectedNet = S[i];
-              S[i]->connectedPorts.push_back(sip);
+              sip->Connect(S[i]);
               inputPorts.push_back(sip);
           }
 
@@ -48,8 +45,7 @@ namespace SynthFramework {
               DeviceOutputPort *op = new DeviceOutputPort();
               op->device = this;
               op->pin = i;
-              op->connectedNet = O[i];
-              O[i]->connectedPorts.push_back(op);
+              op->Connect(O[i]);
               outputPorts.push_back(op);
           }
 
@@ -57,8 +53,7 @@ namespace SynthFramework {
               DeviceOutputPort *cop = new DeviceOutputPort();
               cop->device = this;
               cop->pin = 4 + i;
-              cop->connectedNet = CO[i];
-              CO[i]->connectedPorts.push_back(cop);
+              cop->Connect(CO[i]);
               outputPorts.push_back(cop);
           }
     }
@@ -68,30 +63,32 @@ namespace SynthFramework {
         /*In the future this should fold constants, deal with outputs with no fanout, etc*/
     }
 
-    int Xilinx_Carry4::carry4count;
+    LogicDevice *Xilinx_Carry4::Clone() {
+        Xilinx_Carry4 *copy = new Xilinx_Carry4(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
 
-    Xilinx_DSP48Mul::Xilinx_DSP48Mul() {
-        name = "dsp48_" + to_string(dsp48count);
-        dsp48count++;
+    Xilinx_DSP48Mul::Xilinx_DSP48Mul() : VendorSpecificDevice(DEVICE_XILINX_DSP48MUL) {
+        name = "dsp48_" + to_string(createdCount[DEVICE_XILINX_DSP48MUL]);
+        createdCount[DEVICE_XILINX_DSP48MUL]++;
     }
 
-    Xilinx_DSP48Mul::Xilinx_DSP48Mul(Signal *clock, vector<Signal*> A, vector<Signal*> B, vector<Signal*> M) {
-        name = "dsp48_" + to_string(dsp48count);
-        dsp48count++;
+    Xilinx_DSP48Mul::Xilinx_DSP48Mul(Signal *clock, vector<Signal*> A, vector<Signal*> B, vector<Signal*> M) : VendorSpecificDevice(DEVICE_XILINX_DSP48MUL) {
+        name = "dsp48_" + to_string(createdCount[DEVICE_XILINX_DSP48MUL]);
+        createdCount[DEVICE_XILINX_DSP48MUL]++;
 
         DeviceInputPort *clkp = new DeviceInputPort();
         clkp->device = this;
         clkp->pin = 1;
-        clkp->connectedNet = clock;
-        clock->connectedPorts.push_back(clkp);
+        clkp->Connect(clock);
         inputPorts.push_back(clkp);
 
         for(int i = 0 ; i < 25; i++) {
             DeviceInputPort *aip = new DeviceInputPort();
             aip->device = this;
             aip->pin = 1 + i;
-            aip->connectedNet = A[i];
-            A[i]->connectedPorts.push_back(aip);
+            aip->Connect(A[i]);
             inputPorts.push_back(aip);
         }
 
@@ -99,8 +96,7 @@ namespace SynthFramework {
             DeviceInputPort *bip = new DeviceInputPort();
             bip->device = this;
             bip->pin = 26 + i;
-            bip->connectedNet = B[i];
-            B[i]->connectedPorts.push_back(bip);
+            bip->Connect(B[i]);
             inputPorts.push_back(bip);
         }
 
@@ -108,13 +104,82 @@ namespace SynthFramework {
             DeviceOutputPort *op = new DeviceOutputPort();
             op->device = this;
             op->pin = i;
-            op->connectedNet = M[i];
-            M[i]->connectedPorts.push_back(op);
+            op->Connect(M[i]);
             outputPorts.push_back(op);
         }
     }
 
-    int Xilinx_DSP48Mul::dsp48count;
+    LogicDevice *Xilinx_DSP48Mul::Clone() {
+        Xilinx_DSP48Mul *copy = new Xilinx_DSP48Mul(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
+
+    void Xilinx_DSP48Mul::WriteConfig(BinaryWriter &out) {
+        out.WriteInt(latency);
+    }
+
+    void Xilinx_DSP48Mul::ReadConfig(BinaryReader &in) {
+        latency = in.ReadInt();
+    }
+
+    Xilinx_SRL::Xilinx_SRL() : VendorSpecificDevice(DEVICE_XILINX_SRL) {
+        name = "srl_" + to_string(createdCount[DEVICE_XILINX_SRL]);
+        createdCount[DEVICE_XILINX_SRL]++;
+    }
+
+    Xilinx_SRL::Xilinx_SRL(int _depth, Signal *D, Signal *clock, Signal *enable, Signal *Q) : VendorSpecificDevice(DEVICE_XILINX_SRL) {
+        name = "srl_" + to_string(createdCount[DEVICE_XILINX_SRL]);
+        createdCount[DEVICE_XILINX_SRL]++;
+        depth = _depth;
+        hasEnable = (enable != nullptr);
+
+        DeviceInputPort *dp = new DeviceInputPort();
+        dp->device = this;
+        dp->pin = 0;
+        dp->Connect(D);
+        inputPorts.push_back(dp);
+
+        DeviceInputPort *clkp = new DeviceInputPort();
+        clkp->device = this;
+        clkp->pin = 1;
+        clkp->Connect(clock);
+        inputPorts.push_back(clkp);
+
+        if(hasEnable) {
+            DeviceInputPort *cep = new DeviceInputPort();
+            cep->device = this;
+            cep->pin = 2;
+            cep->Connect(enable);
+            inputPorts.push_back(cep);
+        }
+
+        DeviceOutputPort *qp = new DeviceOutputPort();
+        qp->device = this;
+        qp->pin = 0;
+        qp->Connect(Q);
+        outputPorts.push_back(qp);
+    }
+
+    LogicDevice *Xilinx_SRL::Clone() {
+        Xilinx_SRL *copy = new Xilinx_SRL(*this);
+        copy->ClearCloneState();
+        return copy;
+    }
+
+    void Xilinx_SRL::WriteConfig(BinaryWriter &out) {
+        out.WriteInt(depth);
+        out.WriteBool(hasEnable);
+    }
+
+    void Xilinx_SRL::ReadConfig(BinaryReader &in) {
+        depth = in.ReadInt();
+        hasEnable = in.ReadBool();
+    }
+
+    bool Xilinx_SRL::IsRegisteredInput(int input) {
+        return input == 0;
+    }
 
   }
 }
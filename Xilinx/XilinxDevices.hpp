@@ -11,22 +11,38 @@ namespace SynthFramework {
       class Xilinx_Carry4 : public VendorSpecificDevice {
       public:
           Xilinx_Carry4();
+          static bool IsKind(DeviceKind k) { return k == DEVICE_XILINX_CARRY4; };
           Xilinx_Carry4(Signal *ci, Signal *cinit, vector<Signal*> DI, vector<Signal*> S, vector<Signal*> O, vector<Signal*> CO);
           virtual bool OptimiseDevice(LogicDesign *topLevel);
-      private:
-          static int carry4count;
+          LogicDevice *Clone();
       };
       //7-series DSP48 configured as a multiplier only
       //Support for more advanced configurations should be considered at a later date (in particular folding multiply and add together)
       class Xilinx_DSP48Mul : public VendorSpecificDevice {
       public:
           Xilinx_DSP48Mul();
+          static bool IsKind(DeviceKind k) { return k == DEVICE_XILINX_DSP48MUL; };
           //A : 25 bit input, B : 18 bit input, M : 43 bit output
           Xilinx_DSP48Mul(Signal *clock, vector<Signal*> A, vector<Signal*> B, vector<Signal*> M);
+          LogicDevice *Clone();
+          void WriteConfig(BinaryWriter &out);
+          void ReadConfig(BinaryReader &in);
           //Configured pipeline latency
           int latency = 0; //0 = no reg, 1 = MREG only, 2 = A and MREG
-      private:
-          static int dsp48count;
+      };
+      //Shift register in a LUT, a SRL16E or a cascade of SRLC32Es for longer delays: see UG768
+      class Xilinx_SRL : public VendorSpecificDevice {
+      public:
+          Xilinx_SRL();
+          static bool IsKind(DeviceKind k) { return k == DEVICE_XILINX_SRL; };
+          //Delays D by depth clock cycles. enable may be nullptr if the shift register is always enabled
+          Xilinx_SRL(int _depth, Signal *D, Signal *clock, Signal *enable, Signal *Q);
+          LogicDevice *Clone();
+          void WriteConfig(BinaryWriter &out);
+          void ReadConfig(BinaryReader &in);
+          bool IsRegisteredInput(int input);
+          int depth = 1;
+          bool hasEnable = false;
       };
   };
 };